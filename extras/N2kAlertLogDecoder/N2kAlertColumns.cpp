@@ -0,0 +1,360 @@
+//
+//
+//
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <map>
+
+#include "N2kAlertColumns.h"
+
+static const char N2kAlertColumnsMagic[8] = { 'N', '2', 'K', 'A', 'C', 'O', 'L', '1' };
+#define N2kAlertColumnsHeaderSize 16
+#define N2kAlertColumnsNameLen 16
+#define N2kAlertColumnsEntrySize (N2kAlertColumnsNameLen + 1 + 8 + 8)
+
+//*****************************************************************************
+// Writer
+
+class tColumnBuffer {
+public:
+	std::vector<uint8_t> Data;
+
+	void AddByte(uint8_t v) { Data.push_back(v); }
+	void AddVarInt(uint64_t v) {
+		while (v >= 0x80) {
+			Data.push_back((v & 0x7f) | 0x80);
+			v >>= 7;
+		}
+		Data.push_back(v);
+	}
+	void AddUInt64(uint64_t v) {
+		for (int i = 0; i < 8; i++, v >>= 8) Data.push_back(v & 0xff);
+	}
+	void AddBytes(const void* v, size_t Len) {
+		Data.insert(Data.end(), (const uint8_t*)v, (const uint8_t*)v + Len);
+	}
+};
+
+// Codes are assigned in order of first use
+template<typename T> class tDictionaryBuilder {
+public:
+	std::vector<T> Values;
+	std::vector<uint32_t> Codes;
+
+	void Add(const T &Value) {
+		typename std::map<T, uint32_t>::iterator it = Index.find(Value);
+		if (it == Index.end()) {
+			it = Index.insert(std::make_pair(Value, (uint32_t)Values.size())).first;
+			Values.push_back(Value);
+		}
+		Codes.push_back(it->second);
+	}
+
+	void AddCodes(tColumnBuffer &Buffer) const {
+		for (size_t i = 0; i < Codes.size(); i++) Buffer.AddVarInt(Codes[i]);
+	}
+
+private:
+	std::map<T, uint32_t> Index;
+};
+
+struct tColumnOut {
+	const char* Name;
+	tN2kAlertColumnEncoding Encoding;
+	tColumnBuffer Buffer;
+};
+
+static void WriteDict(tColumnBuffer &Buffer, const tDictionaryBuilder<uint64_t> &Dict) {
+	Buffer.AddVarInt(Dict.Values.size());
+	for (size_t i = 0; i < Dict.Values.size(); i++) Buffer.AddVarInt(Dict.Values[i]);
+	Dict.AddCodes(Buffer);
+}
+
+static void WriteDict(tColumnBuffer &Buffer, const tDictionaryBuilder<tN2kAlertUID> &Dict) {
+	Buffer.AddVarInt(Dict.Values.size());
+	for (size_t i = 0; i < Dict.Values.size(); i++) {
+		Buffer.AddUInt64(Dict.Values[i].Code);
+		Buffer.AddUInt64(Dict.Values[i].SourceNetworkID);
+	}
+	Dict.AddCodes(Buffer);
+}
+
+static void WriteDict(tColumnBuffer &Buffer, const tDictionaryBuilder<std::string> &Dict) {
+	Buffer.AddVarInt(Dict.Values.size());
+	for (size_t i = 0; i < Dict.Values.size(); i++) {
+		Buffer.AddVarInt(Dict.Values[i].size());
+		Buffer.AddBytes(Dict.Values[i].data(), Dict.Values[i].size());
+	}
+	Dict.AddCodes(Buffer);
+}
+
+enum tColumnIndex {
+	ColTime, ColPGN, ColSource, ColAlert, ColInstance, ColIndex, ColOccurence, ColState, ColThreshold,
+	ColPriority, ColTrigger, ColFlags, ColCommand, ColAckName, ColLanguage, ColText, ColLocation, ColCount
+};
+
+bool N2kAlertWriteColumns(const char* FileName, const std::vector<tAlertEvent> &Events) {
+	tColumnOut Columns[ColCount] = {
+		{ "time", N2kAlertColumnDelta }, { "pgn", N2kAlertColumnDict }, { "source", N2kAlertColumnBytes },
+		{ "alert", N2kAlertColumnDictUID }, { "instance", N2kAlertColumnBytes }, { "index", N2kAlertColumnBytes },
+		{ "occurence", N2kAlertColumnBytes }, { "state", N2kAlertColumnBytes }, { "threshold", N2kAlertColumnBytes },
+		{ "priority", N2kAlertColumnBytes }, { "trigger", N2kAlertColumnBytes }, { "flags", N2kAlertColumnBytes },
+		{ "command", N2kAlertColumnBytes }, { "ackname", N2kAlertColumnDict }, { "language", N2kAlertColumnBytes },
+		{ "text", N2kAlertColumnDictText }, { "location", N2kAlertColumnDictText }
+	};
+	tDictionaryBuilder<uint64_t> PGNs;
+	tDictionaryBuilder<tN2kAlertUID> Alerts;
+	tDictionaryBuilder<uint64_t> AckNames;
+	tDictionaryBuilder<std::string> Texts;
+	tDictionaryBuilder<std::string> Locations;
+	uint64_t LastTime = 0;
+
+	for (size_t i = 0; i < Events.size(); i++) {
+		const tAlertEvent &Event = Events[i];
+		const tN2kAlertKey &Key = Event.Notification.Key;	// Key is the first field of all records
+		int64_t Delta = (int64_t)(Event.Time - LastTime);
+		uint8_t Flags = 0;
+
+		Columns[ColTime].Buffer.AddVarInt(((uint64_t)Delta << 1) ^ (uint64_t)(Delta >> 63));
+		LastTime = Event.Time;
+		PGNs.Add(Event.PGN);
+		Columns[ColSource].Buffer.AddByte(Event.Source);
+		Alerts.Add(Event.UID);
+		Columns[ColInstance].Buffer.AddByte(Key.DataSourceInstance);
+		Columns[ColIndex].Buffer.AddByte(Key.DataSourceIndex);
+		Columns[ColOccurence].Buffer.AddByte(Key.AlertOccurence);
+
+		if (Event.PGN == 126983) {
+			const tN2kAlertNotification &n = Event.Notification;
+			if (n.TemporarySilenceStatus == N2kts_AlertYes) Flags |= N2kAlertColumnFlagSilenced;
+			if (n.AcknowledgeStatus == N2kts_AlertYes) Flags |= N2kAlertColumnFlagAcknowledged;
+			if (n.EscalationStatus == N2kts_AlertYes) Flags |= N2kAlertColumnFlagEscalated;
+			if (n.TemporarySilenceSupport == N2kts_AlertYes) Flags |= N2kAlertColumnFlagSilenceSupport;
+			if (n.AcknowledgeSupport == N2kts_AlertYes) Flags |= N2kAlertColumnFlagAcknowledgeSupport;
+			if (n.EscalationSupport == N2kts_AlertYes) Flags |= N2kAlertColumnFlagEscalationSupport;
+			Columns[ColState].Buffer.AddByte(n.AlertState);
+			Columns[ColThreshold].Buffer.AddByte(n.ThresholdStatus);
+			Columns[ColPriority].Buffer.AddByte(n.AlertPriority);
+			Columns[ColTrigger].Buffer.AddByte(n.TriggerCondition);
+			Columns[ColFlags].Buffer.AddByte(Flags);
+			AckNames.Add(n.AcknowledgeNetworkID);
+		}
+		else {
+			Columns[ColState].Buffer.AddByte(0xff);
+			Columns[ColThreshold].Buffer.AddByte(0xff);
+			Columns[ColPriority].Buffer.AddByte(0xff);
+			Columns[ColTrigger].Buffer.AddByte(0xff);
+			Columns[ColFlags].Buffer.AddByte(0xff);
+			AckNames.Add((Event.PGN == 126984) ? Event.Response.AcknowledgeNetworkID : 0);
+		}
+		Columns[ColCommand].Buffer.AddByte((Event.PGN == 126984) ? (uint8_t)Event.Response.ResponseCommand : 0xff);
+
+		if (Event.PGN == 126985) {
+			Columns[ColLanguage].Buffer.AddByte(Event.Text.AlertLanguage);
+			Texts.Add(Event.Text.AlertTextDescription);
+			Locations.Add(Event.Text.AlertLocationTextDescription);
+		}
+		else {
+			Columns[ColLanguage].Buffer.AddByte(0xff);
+			Texts.Add(std::string());
+			Locations.Add(std::string());
+		}
+	}
+	WriteDict(Columns[ColPGN].Buffer, PGNs);
+	WriteDict(Columns[ColAlert].Buffer, Alerts);
+	WriteDict(Columns[ColAckName].Buffer, AckNames);
+	WriteDict(Columns[ColText].Buffer, Texts);
+	WriteDict(Columns[ColLocation].Buffer, Locations);
+
+	tColumnBuffer Header;
+	uint64_t Offset = N2kAlertColumnsHeaderSize + ColCount * N2kAlertColumnsEntrySize;
+	uint32_t Rows = (uint32_t)Events.size();
+	uint32_t Count = ColCount;
+
+	Header.AddBytes(N2kAlertColumnsMagic, sizeof(N2kAlertColumnsMagic));
+	for (int i = 0; i < 4; i++) Header.AddByte(Rows >> (i * 8));
+	for (int i = 0; i < 4; i++) Header.AddByte(Count >> (i * 8));
+	for (int i = 0; i < ColCount; i++) {
+		char Name[N2kAlertColumnsNameLen] = { 0 };
+		memcpy(Name, Columns[i].Name, strlen(Columns[i].Name));	// Names are shorter than N2kAlertColumnsNameLen
+		Header.AddBytes(Name, N2kAlertColumnsNameLen);
+		Header.AddByte(Columns[i].Encoding);
+		Header.AddUInt64(Offset);
+		Header.AddUInt64(Columns[i].Buffer.Data.size());
+		Offset += Columns[i].Buffer.Data.size();
+	}
+
+	FILE* f = fopen(FileName, "wb");
+	if (f == 0) return false;
+	bool Result = fwrite(Header.Data.data(), 1, Header.Data.size(), f) == Header.Data.size();
+	for (int i = 0; (i < ColCount) && Result; i++) {
+		const std::vector<uint8_t> &Data = Columns[i].Buffer.Data;
+		Result = Data.empty() || (fwrite(Data.data(), 1, Data.size(), f) == Data.size());
+	}
+	return (fclose(f) == 0) && Result;
+}
+
+//*****************************************************************************
+// Reader
+
+static bool GetVarInt(const uint8_t* &p, const uint8_t* End, uint64_t &Value) {
+	Value = 0;
+	for (int Shift = 0; (p < End) && (Shift < 64); Shift += 7) {
+		uint8_t b = *p++;
+		Value |= (uint64_t)(b & 0x7f) << Shift;
+		if ((b & 0x80) == 0) return true;
+	}
+	return false;
+}
+
+static uint64_t GetUInt64(const uint8_t* p) {
+	uint64_t v = 0;
+	for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+	return v;
+}
+
+tN2kAlertColumnReader::tN2kAlertColumnReader() : Data(0), Size(0), RowCount(0) {
+}
+
+tN2kAlertColumnReader::~tN2kAlertColumnReader() {
+	Close();
+}
+
+bool tN2kAlertColumnReader::Open(const char* FileName) {
+	struct stat st;
+	int fd;
+
+	Close();
+	if ((fd = open(FileName, O_RDONLY)) < 0) return false;
+	if ((fstat(fd, &st) != 0) || (st.st_size < N2kAlertColumnsHeaderSize)) {
+		close(fd);
+		return false;
+	}
+	void* Map = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (Map == MAP_FAILED) return false;
+	Data = (const uint8_t*)Map;
+	Size = st.st_size;
+
+	uint32_t Count = Data[12] | (Data[13] << 8) | (Data[14] << 16) | ((uint32_t)Data[15] << 24);
+	if ((memcmp(Data, N2kAlertColumnsMagic, sizeof(N2kAlertColumnsMagic)) != 0) ||
+		(Size < N2kAlertColumnsHeaderSize + (uint64_t)Count * N2kAlertColumnsEntrySize)) {
+		Close();
+		return false;
+	}
+	RowCount = Data[8] | (Data[9] << 8) | (Data[10] << 16) | ((uint32_t)Data[11] << 24);
+	Columns.resize(Count);
+	for (uint32_t i = 0; i < Count; i++) {
+		const uint8_t* Entry = Data + N2kAlertColumnsHeaderSize + i * N2kAlertColumnsEntrySize;
+		memcpy(Columns[i].Name, Entry, N2kAlertColumnsNameLen);
+		Columns[i].Name[N2kAlertColumnsNameLen] = '\0';
+		Columns[i].Encoding = (tN2kAlertColumnEncoding)Entry[N2kAlertColumnsNameLen];
+		Columns[i].Offset = GetUInt64(Entry + N2kAlertColumnsNameLen + 1);
+		Columns[i].Size = GetUInt64(Entry + N2kAlertColumnsNameLen + 9);
+		if ((Columns[i].Offset > Size) || (Columns[i].Size > Size - Columns[i].Offset)) {
+			Close();
+			return false;
+		}
+	}
+	return true;
+}
+
+void tN2kAlertColumnReader::Close() {
+	if (Data != 0) munmap((void*)Data, Size);
+	Data = 0;
+	Size = 0;
+	RowCount = 0;
+	Columns.clear();
+}
+
+int tN2kAlertColumnReader::FindColumn(const char* Name) const {
+	for (size_t i = 0; i < Columns.size(); i++) {
+		if (strcmp(Columns[i].Name, Name) == 0) return (int)i;
+	}
+	return -1;
+}
+
+bool tN2kAlertColumnReader::ReadCodes(const uint8_t* &p, const uint8_t* End, size_t DictionarySize, std::vector<uint32_t> &Codes) const {
+	uint64_t Code;
+
+	Codes.resize(RowCount);
+	for (uint32_t i = 0; i < RowCount; i++) {
+		if (!GetVarInt(p, End, Code) || (Code >= DictionarySize)) return false;
+		Codes[i] = (uint32_t)Code;
+	}
+	return true;
+}
+
+bool tN2kAlertColumnReader::ReadValues(int Column, std::vector<uint64_t> &Values) const {
+	if ((Column < 0) || (Column >= (int)Columns.size())) return false;
+	const uint8_t* p = Data + Columns[Column].Offset;
+	const uint8_t* End = p + Columns[Column].Size;
+	uint64_t v;
+
+	Values.resize(RowCount);
+	switch (Columns[Column].Encoding) {
+		case N2kAlertColumnBytes:
+			if (Columns[Column].Size < RowCount) return false;
+			for (uint32_t i = 0; i < RowCount; i++) Values[i] = p[i];
+			return true;
+		case N2kAlertColumnDelta: {
+			uint64_t Last = 0;
+			for (uint32_t i = 0; i < RowCount; i++) {
+				if (!GetVarInt(p, End, v)) return false;
+				Last += (v >> 1) ^ (0 - (v & 1));
+				Values[i] = Last;
+			}
+			return true;
+		}
+		case N2kAlertColumnDict: {
+			std::vector<uint64_t> Dictionary;
+			std::vector<uint32_t> Codes;
+			if (!GetVarInt(p, End, v) || (v > Columns[Column].Size)) return false;
+			Dictionary.resize(v);
+			for (size_t i = 0; i < Dictionary.size(); i++) {
+				if (!GetVarInt(p, End, Dictionary[i])) return false;
+			}
+			if (!ReadCodes(p, End, Dictionary.size(), Codes)) return false;
+			for (uint32_t i = 0; i < RowCount; i++) Values[i] = Dictionary[Codes[i]];
+			return true;
+		}
+		default:
+			return false;
+	}
+}
+
+bool tN2kAlertColumnReader::ReadUIDs(int Column, std::vector<uint32_t> &Codes, std::vector<tN2kAlertUID> &Dictionary) const {
+	if ((Column < 0) || (Column >= (int)Columns.size()) || (Columns[Column].Encoding != N2kAlertColumnDictUID)) return false;
+	const uint8_t* p = Data + Columns[Column].Offset;
+	const uint8_t* End = p + Columns[Column].Size;
+	uint64_t Count;
+
+	if (!GetVarInt(p, End, Count) || (Count > (uint64_t)(End - p) / 16)) return false;
+	Dictionary.resize(Count);
+	for (size_t i = 0; i < Dictionary.size(); i++, p += 16) {
+		Dictionary[i].Code = GetUInt64(p);
+		Dictionary[i].SourceNetworkID = GetUInt64(p + 8);
+	}
+	return ReadCodes(p, End, Dictionary.size(), Codes);
+}
+
+bool tN2kAlertColumnReader::ReadTexts(int Column, std::vector<uint32_t> &Codes, std::vector<std::string> &Dictionary) const {
+	if ((Column < 0) || (Column >= (int)Columns.size()) || (Columns[Column].Encoding != N2kAlertColumnDictText)) return false;
+	const uint8_t* p = Data + Columns[Column].Offset;
+	const uint8_t* End = p + Columns[Column].Size;
+	uint64_t Count;
+	uint64_t Len;
+
+	if (!GetVarInt(p, End, Count) || (Count > Columns[Column].Size)) return false;
+	Dictionary.resize(Count);
+	for (size_t i = 0; i < Dictionary.size(); i++) {
+		if (!GetVarInt(p, End, Len) || (Len > (uint64_t)(End - p))) return false;
+		Dictionary[i].assign((const char*)p, Len);
+		p += Len;
+	}
+	return ReadCodes(p, End, Dictionary.size(), Codes);
+}
@@ -0,0 +1,101 @@
+// N2kAlertColumns.h
+//
+// Columnar export of decoded alert messages.
+//
+// The file stores one column per field instead of one row per message, so an
+// analysis that needs only a few fields reads only those. Layout:
+//
+//   magic "N2KACOL1", uint32 row count, uint32 column count
+//   column directory: name[16], uint8 encoding, uint64 offset, uint64 size
+//   column data
+//
+// All integers are little endian. Encodings:
+//   Bytes      one byte per row
+//   Delta      zigzag varint of the difference to the previous row (time)
+//   Dict       varint dictionary size, varint values, varint code per row
+//   DictUID    as Dict with 16 byte tN2kAlertUID entries
+//   DictText   as Dict with varint length prefixed strings
+//
+// Fields that do not apply to a row, e.g. the response command of a
+// notification, are 0xff in byte columns and 0 or "" in dictionary columns.
+
+#ifndef _N2KALERTCOLUMNS_h
+#define _N2KALERTCOLUMNS_h
+
+#include <string>
+#include <vector>
+
+#include "N2kAlertMessages.h"
+
+struct tAlertEvent {
+	uint64_t Time;		// us, since 1970 or since midnight for N2K ASCII logs
+	uint32_t PGN;
+	uint8_t Source;
+	tN2kAlertUID UID;
+	union {
+		tN2kAlertNotification Notification;
+		tN2kAlertResponse Response;
+		tN2kAlertText Text;
+	};
+};
+
+enum tN2kAlertColumnEncoding {
+	N2kAlertColumnBytes = 0,
+	N2kAlertColumnDelta = 1,
+	N2kAlertColumnDict = 2,
+	N2kAlertColumnDictUID = 3,
+	N2kAlertColumnDictText = 4
+};
+
+// Flags column
+#define N2kAlertColumnFlagSilenced 0x01
+#define N2kAlertColumnFlagAcknowledged 0x02
+#define N2kAlertColumnFlagEscalated 0x04
+#define N2kAlertColumnFlagSilenceSupport 0x08
+#define N2kAlertColumnFlagAcknowledgeSupport 0x10
+#define N2kAlertColumnFlagEscalationSupport 0x20
+
+// Writes the columns time, pgn, source, alert, instance, index, occurence,
+// state, threshold, priority, trigger, flags, command, ackname, language,
+// text and location.
+bool N2kAlertWriteColumns(const char* FileName, const std::vector<tAlertEvent> &Events);
+
+class tN2kAlertColumnReader {
+public:
+	tN2kAlertColumnReader();
+	~tN2kAlertColumnReader();
+
+	bool Open(const char* FileName);
+	void Close();
+
+	uint32_t GetRowCount() const { return RowCount; }
+	uint32_t GetColumnCount() const { return (uint32_t)Columns.size(); }
+	const char* GetColumnName(uint32_t Index) const { return Columns[Index].Name; }
+	int FindColumn(const char* Name) const;
+	tN2kAlertColumnEncoding GetEncoding(int Column) const { return Columns[Column].Encoding; }
+
+	// Only the requested column is read from the mapped file. Numeric columns
+	// decode to one value per row, dictionary columns to their codes plus the
+	// dictionary.
+	bool ReadValues(int Column, std::vector<uint64_t> &Values) const;
+	bool ReadUIDs(int Column, std::vector<uint32_t> &Codes, std::vector<tN2kAlertUID> &Dictionary) const;
+	bool ReadTexts(int Column, std::vector<uint32_t> &Codes, std::vector<std::string> &Dictionary) const;
+
+private:
+	struct tColumn {
+		char Name[17];
+		tN2kAlertColumnEncoding Encoding;
+		uint64_t Offset;
+		uint64_t Size;
+	};
+
+	const uint8_t* Data;
+	size_t Size;
+	uint32_t RowCount;
+	std::vector<tColumn> Columns;
+
+	// Fails on a code that is not below DictionarySize
+	bool ReadCodes(const uint8_t* &p, const uint8_t* End, size_t DictionarySize, std::vector<uint32_t> &Codes) const;
+};
+
+#endif
@@ -0,0 +1,615 @@
+// N2kAlertLogDecoder.cpp
+//
+// Host tool that extracts the alert PGNs 126983, 126984 and 126985 from
+// recorded NMEA 2000 bus logs and prints a timeline per alert.
+//
+// Supported log formats, detected per line:
+//   candump -L          (1436509052.249713) can0 09F20183#0102030405060708
+//   candump [-t a]      (1436509052.249713)  can0  09F20183   [8]  01 02 03 04 05 06 07 08
+//   Actisense/canboat   2011-11-24-22:42:04.388,2,126983,36,255,28,01,02,03,...
+//   Actisense N2K ASCII A173321.107 23FF7 1F007 0102030405...
+//
+// The file is memory mapped and split into one chunk per thread at line
+// boundaries. Each thread decodes the lines starting in its chunk; fast packet
+// sequences that start near the end of a chunk are completed from the lines
+// after it. CAN frames of other PGNs are dropped after the identifier is read,
+// so the payload of the bulk of the traffic is never converted.
+//
+// Build with the NMEA2000 library (https://github.com/ttlappalainen/NMEA2000):
+//   N2K=<path to NMEA2000>/src
+//   g++ -O2 -std=c++11 -pthread -I. -I../../src -I$N2K -o N2kAlertLogDecoder
+//       N2kAlertLogDecoder.cpp N2kAlertColumns.cpp ../../src/N2kAlertMessages.cpp
+//       $N2K/N2kMsg.cpp $N2K/N2kMessages.cpp $N2K/N2kStream.cpp $N2K/N2kTimer.cpp
+//
+// Usage:
+//   N2kAlertLogDecoder [-j threads] log...             print timelines
+//   N2kAlertLogDecoder [-j threads] -x out.n2kc log... export columns, see N2kAlertColumns.h
+//   N2kAlertLogDecoder -s column out.n2kc             print one column of an export
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "N2kAlertMessagesEnumToStr.h"
+#include "N2kAlertColumns.h"
+
+// Lines read after the end of a chunk to complete open fast packets
+#define N2kAlertLogMaxOverlapLines 256
+// Fast packet sequences assembled at the same time per thread
+#define N2kAlertLogMaxFastPackets 32
+
+//*****************************************************************************
+// Line parsing
+
+struct tLogFrame {
+	uint64_t Time;
+	uint32_t PGN;
+	uint8_t Source;
+	uint8_t Priority;
+	bool Complete;		// Data holds the whole message, no fast packet frame
+	int DataLen;
+	uint8_t Data[MaxN2kMsgDataLen];
+};
+
+static inline bool IsAlertPGN(uint32_t PGN) {
+	return (PGN >= 126983) && (PGN <= 126985);
+}
+
+static inline int HexDigit(char c) {
+	if ((c >= '0') && (c <= '9')) return c - '0';
+	c |= 0x20;
+	if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+	return -1;
+}
+
+static inline void SkipSpaces(const char* &p, const char* End) {
+	while ((p < End) && ((*p == ' ') || (*p == '\t'))) p++;
+}
+
+static inline bool ParseHex(const char* &p, const char* End, uint32_t &Value) {
+	const char* Start = p;
+	int d;
+
+	Value = 0;
+	while ((p < End) && ((d = HexDigit(*p)) >= 0)) {
+		Value = (Value << 4) | d;
+		p++;
+	}
+	return p > Start;
+}
+
+static inline bool ParseDec(const char* &p, const char* End, uint32_t &Value) {
+	const char* Start = p;
+
+	Value = 0;
+	while ((p < End) && (*p >= '0') && (*p <= '9')) {
+		Value = Value * 10 + (*p - '0');
+		p++;
+	}
+	return p > Start;
+}
+
+// seconds.fraction to us
+static bool ParseSeconds(const char* &p, const char* End, uint64_t &Time) {
+	uint32_t Seconds;
+	uint32_t Scale = 1000000;
+
+	if (!ParseDec(p, End, Seconds)) return false;
+	Time = (uint64_t)Seconds * 1000000;
+	if ((p < End) && (*p == '.')) {
+		for (p++; (p < End) && (*p >= '0') && (*p <= '9'); p++) {
+			Scale /= 10;
+			Time += (*p - '0') * Scale;
+		}
+	}
+	return true;
+}
+
+// Days since 1970-01-01 of a date in the Gregorian calendar
+static int64_t DaysFromCivil(int64_t y, unsigned m, unsigned d) {
+	y -= (m <= 2);
+	int64_t Era = (y >= 0 ? y : y - 399) / 400;
+	unsigned YearOfEra = (unsigned)(y - Era * 400);
+	unsigned DayOfYear = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+	unsigned DayOfEra = YearOfEra * 365 + YearOfEra / 4 - YearOfEra / 100 + DayOfYear;
+	return Era * 146097 + (int64_t)DayOfEra - 719468;
+}
+
+static inline void SetFramePGN(tLogFrame &Frame, uint32_t Id) {
+	uint8_t PF = (Id >> 16) & 0xff;
+
+	Frame.Priority = (Id >> 26) & 0x7;
+	Frame.Source = Id & 0xff;
+	Frame.PGN = ((Id >> 8) & 0x1ff00) | ((PF >= 240) ? ((Id >> 8) & 0xff) : 0);
+}
+
+// candump, with or without -L and -t a
+static bool ParseCanDump(const char* p, const char* End, tLogFrame &Frame) {
+	uint32_t Id;
+	uint32_t Len;
+	int d1, d2;
+
+	Frame.Time = 0;
+	if (*p == '(') {
+		p++;
+		if (!ParseSeconds(p, End, Frame.Time)) return false;
+		if ((p >= End) || (*p != ')')) return false;
+		p++;
+	}
+	SkipSpaces(p, End);
+	while ((p < End) && (*p != ' ') && (*p != '\t')) p++;	// Interface
+	SkipSpaces(p, End);
+
+	const char* IdStart = p;
+	if (!ParseHex(p, End, Id) || (p - IdStart != 8)) return false;	// NMEA 2000 uses extended ids only
+	SetFramePGN(Frame, Id);
+	if (!IsAlertPGN(Frame.PGN)) return false;
+
+	Frame.Complete = false;
+	Frame.DataLen = 0;
+	if ((p < End) && (*p == '#')) {
+		for (p++; (p + 1 < End) && (Frame.DataLen < 8); p += 2) {
+			if (((d1 = HexDigit(p[0])) < 0) || ((d2 = HexDigit(p[1])) < 0)) break;
+			Frame.Data[Frame.DataLen++] = (d1 << 4) | d2;
+		}
+		return true;
+	}
+
+	SkipSpaces(p, End);
+	if ((p >= End) || (*p != '[')) return false;
+	p++;
+	if (!ParseDec(p, End, Len) || (Len > 8) || (p >= End) || (*p != ']')) return false;
+	p++;
+	while (Frame.DataLen < (int)Len) {
+		SkipSpaces(p, End);
+		if ((p + 1 >= End) || ((d1 = HexDigit(p[0])) < 0) || ((d2 = HexDigit(p[1])) < 0)) return false;
+		Frame.Data[Frame.DataLen++] = (d1 << 4) | d2;
+		p += 2;
+	}
+	return true;
+}
+
+// Actisense/canboat plain format: timestamp,prio,pgn,src,dst,len,data...
+static bool ParseCanboat(const char* p, const char* End, tLogFrame &Frame) {
+	uint32_t Year, Month, Day, Hour, Minute;
+	uint32_t Field;
+	uint64_t Seconds;
+	int d1, d2;
+
+	if (!ParseDec(p, End, Year) || (p >= End) || (*p++ != '-')) return false;
+	if (!ParseDec(p, End, Month) || (p >= End) || (*p++ != '-')) return false;
+	if (!ParseDec(p, End, Day) || (p >= End) || ((*p != '-') && (*p != 'T') && (*p != ' '))) return false;
+	p++;
+	if (!ParseDec(p, End, Hour) || (p >= End) || (*p++ != ':')) return false;
+	if (!ParseDec(p, End, Minute) || (p >= End) || (*p++ != ':')) return false;
+	if (!ParseSeconds(p, End, Seconds)) return false;
+	Frame.Time = ((uint64_t)DaysFromCivil(Year, Month, Day) * 86400 + Hour * 3600 + Minute * 60) * 1000000 + Seconds;
+	while ((p < End) && (*p != ',')) p++;	// Time zone
+
+	if ((p >= End) || !ParseDec(++p, End, Field)) return false;
+	Frame.Priority = Field;
+	if ((p >= End) || !ParseDec(++p, End, Field)) return false;
+	Frame.PGN = Field;
+	if (!IsAlertPGN(Frame.PGN)) return false;
+	if ((p >= End) || !ParseDec(++p, End, Field)) return false;
+	Frame.Source = Field;
+	if ((p >= End) || !ParseDec(++p, End, Field)) return false;	// Destination
+	if ((p >= End) || !ParseDec(++p, End, Field) || (Field > MaxN2kMsgDataLen)) return false;
+
+	Frame.Complete = true;
+	Frame.DataLen = 0;
+	while (Frame.DataLen < (int)Field) {
+		if ((p + 2 >= End) || (*p != ',') || ((d1 = HexDigit(p[1])) < 0) || ((d2 = HexDigit(p[2])) < 0)) return false;
+		Frame.Data[Frame.DataLen++] = (d1 << 4) | d2;
+		p += 3;
+	}
+	return true;
+}
+
+// Actisense N2K ASCII: Ahhmmss.ddd SSDDP PPPPP data
+static bool ParseN2kAscii(const char* p, const char* End, tLogFrame &Frame) {
+	uint32_t Time;
+	uint32_t Value;
+	int d1, d2;
+
+	p++;
+	const char* TimeStart = p;
+	if (!ParseDec(p, End, Time) || (p - TimeStart != 6)) return false;
+	Frame.Time = ((uint64_t)(Time / 10000) * 3600 + ((Time / 100) % 100) * 60 + Time % 100) * 1000000;
+	if ((p < End) && (*p == '.')) {
+		uint32_t Scale = 1000000;
+		for (p++; (p < End) && (*p >= '0') && (*p <= '9'); p++) {
+			Scale /= 10;
+			Frame.Time += (*p - '0') * Scale;
+		}
+	}
+	SkipSpaces(p, End);
+	if (!ParseHex(p, End, Value)) return false;
+	Frame.Source = Value >> 12;
+	Frame.Priority = Value & 0xf;
+	SkipSpaces(p, End);
+	if (!ParseHex(p, End, Frame.PGN) || !IsAlertPGN(Frame.PGN)) return false;
+	SkipSpaces(p, End);
+
+	Frame.Complete = true;
+	Frame.DataLen = 0;
+	while ((p + 1 < End) && (Frame.DataLen < MaxN2kMsgDataLen) && ((d1 = HexDigit(p[0])) >= 0) && ((d2 = HexDigit(p[1])) >= 0)) {
+		Frame.Data[Frame.DataLen++] = (d1 << 4) | d2;
+		p += 2;
+	}
+	return true;
+}
+
+static bool ParseLine(const char* p, const char* End, tLogFrame &Frame) {
+	if (p >= End) return false;
+	if ((*p >= '0') && (*p <= '9')) return ParseCanboat(p, End, Frame);
+	if ((*p == 'A') && (p + 1 < End) && (p[1] >= '0') && (p[1] <= '9')) return ParseN2kAscii(p, End, Frame);
+	return ParseCanDump(p, End, Frame);
+}
+
+//*****************************************************************************
+// Fast packet assembly
+
+class tFastPacketAssembler {
+public:
+	tFastPacketAssembler() : OpenCount(0) {
+		for (int i = 0; i < N2kAlertLogMaxFastPackets; i++) Slots[i].Used = false;
+	}
+
+	int GetOpenCount() const { return OpenCount; }
+
+	// Returns true when Frame completes a message. New sequences are only
+	// started when AllowNew is set.
+	bool Add(const tLogFrame &Frame, bool AllowNew, tLogFrame &Msg) {
+		if (Frame.DataLen < 1) return false;
+		uint8_t Sequence = Frame.Data[0] >> 5;
+		uint8_t Counter = Frame.Data[0] & 0x1f;
+		tSlot* Slot = Find(Frame.Source, Frame.PGN, Sequence);
+
+		if (Counter == 0) {
+			if (Frame.DataLen < 2) return false;
+			if (Slot == 0) {
+				if (!AllowNew || ((Slot = Find(0, 0, 0, true)) == 0)) return false;
+				Slot->Used = true;
+				OpenCount++;
+			}
+			Slot->Source = Frame.Source;
+			Slot->PGN = Frame.PGN;
+			Slot->Sequence = Sequence;
+			Slot->NextCounter = 1;
+			Slot->Msg.Time = Frame.Time;
+			Slot->Msg.PGN = Frame.PGN;
+			Slot->Msg.Source = Frame.Source;
+			Slot->Msg.Priority = Frame.Priority;
+			Slot->Msg.Complete = true;
+			Slot->Length = (Frame.Data[1] <= MaxN2kMsgDataLen) ? Frame.Data[1] : MaxN2kMsgDataLen;
+			Slot->Msg.DataLen = 0;
+			Append(*Slot, Frame.Data + 2, Frame.DataLen - 2);
+		}
+		else {
+			if (Slot == 0) return false;
+			if (Counter != Slot->NextCounter) {	// Lost frame
+				Release(*Slot);
+				return false;
+			}
+			Slot->NextCounter++;
+			Append(*Slot, Frame.Data + 1, Frame.DataLen - 1);
+		}
+
+		if (Slot->Msg.DataLen < Slot->Length) return false;
+		Msg = Slot->Msg;
+		Release(*Slot);
+		return true;
+	}
+
+private:
+	struct tSlot {
+		bool Used;
+		uint8_t Source;
+		uint32_t PGN;
+		uint8_t Sequence;
+		uint8_t NextCounter;
+		int Length;
+		tLogFrame Msg;
+	};
+	tSlot Slots[N2kAlertLogMaxFastPackets];
+	int OpenCount;
+
+	tSlot* Find(uint8_t Source, uint32_t PGN, uint8_t Sequence, bool Free = false) {
+		for (int i = 0; i < N2kAlertLogMaxFastPackets; i++) {
+			if (Free) {
+				if (!Slots[i].Used) return &Slots[i];
+			}
+			else if (Slots[i].Used && (Slots[i].Source == Source) && (Slots[i].PGN == PGN) && (Slots[i].Sequence == Sequence)) {
+				return &Slots[i];
+			}
+		}
+		return 0;
+	}
+
+	void Append(tSlot &Slot, const uint8_t* Data, int Len) {
+		for (int i = 0; (i < Len) && (Slot.Msg.DataLen < Slot.Length); i++) {
+			Slot.Msg.Data[Slot.Msg.DataLen++] = Data[i];
+		}
+	}
+
+	void Release(tSlot &Slot) {
+		Slot.Used = false;
+		OpenCount--;
+	}
+};
+
+//*****************************************************************************
+// Decoding
+
+static bool DecodeMsg(const tLogFrame &Msg, tAlertEvent &Event) {
+	tN2kMsg N2kMsg(Msg.Source, Msg.Priority, Msg.PGN, 0);
+
+	memcpy(N2kMsg.Data, Msg.Data, Msg.DataLen);
+	N2kMsg.DataLen = Msg.DataLen;
+
+	Event.Time = Msg.Time;
+	Event.PGN = Msg.PGN;
+	Event.Source = Msg.Source;
+	switch (Msg.PGN) {
+		case 126983:
+			if (!ParseN2kAlert(N2kMsg, Event.Notification)) return false;
+			Event.UID = Event.Notification.Key.UID;
+			return true;
+		case 126984:
+			if (!ParseN2kAlertResponse(N2kMsg, Event.Response)) return false;
+			Event.UID = Event.Response.Key.UID;
+			return true;
+		case 126985:
+			if (!ParseN2kAlertText(N2kMsg, Event.Text)) return false;
+			Event.UID = Event.Text.Key.UID;
+			return true;
+	}
+	return false;
+}
+
+struct tChunk {
+	const char* Start;
+	const char* End;
+	const char* FileEnd;
+	uint64_t Frames;
+	std::vector<tAlertEvent> Events;
+};
+
+static void DecodeChunk(tChunk* Chunk) {
+	tFastPacketAssembler Assembler;
+	tLogFrame Frame;
+	tLogFrame Msg;
+	tAlertEvent Event;
+	int OverlapLines = 0;
+	const char* p = Chunk->Start;
+
+	Chunk->Frames = 0;
+	while (p < Chunk->FileEnd) {
+		const char* Eol = (const char*)memchr(p, '\n', Chunk->FileEnd - p);
+		if (Eol == 0) Eol = Chunk->FileEnd;
+		bool InChunk = (p < Chunk->End);
+		if (!InChunk && ((Assembler.GetOpenCount() == 0) || (++OverlapLines > N2kAlertLogMaxOverlapLines))) break;
+
+		if (ParseLine(p, Eol, Frame)) {
+			if (InChunk) Chunk->Frames++;
+			if (Frame.Complete) {
+				if (InChunk && DecodeMsg(Frame, Event)) Chunk->Events.push_back(Event);
+			}
+			else if (Assembler.Add(Frame, InChunk, Msg) && DecodeMsg(Msg, Event)) {
+				Chunk->Events.push_back(Event);
+			}
+		}
+		p = Eol + 1;
+	}
+}
+
+// Decodes one file and appends its events in file order
+static bool DecodeFile(const char* FileName, int Threads, std::vector<tAlertEvent> &Events, uint64_t &Bytes, uint64_t &Frames) {
+	struct stat st;
+	int fd = open(FileName, O_RDONLY);
+
+	if (fd < 0) {
+		fprintf(stderr, "%s: cannot open\n", FileName);
+		return false;
+	}
+	if (fstat(fd, &st) != 0) {
+		fprintf(stderr, "%s: cannot stat\n", FileName);
+		close(fd);
+		return false;
+	}
+	if (st.st_size == 0) {
+		close(fd);
+		return true;
+	}
+	const char* Data = (const char*)mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (Data == MAP_FAILED) {
+		fprintf(stderr, "%s: cannot map\n", FileName);
+		return false;
+	}
+	madvise((void*)Data, st.st_size, MADV_SEQUENTIAL);
+
+	const char* End = Data + st.st_size;
+	if (st.st_size < (1 << 20)) Threads = 1;
+	std::vector<tChunk> Chunks(Threads);
+	for (int i = 0; i < Threads; i++) {
+		const char* Start = Data + (uint64_t)st.st_size * i / Threads;
+		if (i > 0) {
+			const char* Eol = (const char*)memchr(Start, '\n', End - Start);
+			Start = (Eol != 0) ? Eol + 1 : End;
+			Chunks[i - 1].End = Start;
+		}
+		Chunks[i].Start = Start;
+		Chunks[i].End = End;
+		Chunks[i].FileEnd = End;
+	}
+
+	std::vector<std::thread> Workers;
+	for (int i = 1; i < Threads; i++) Workers.push_back(std::thread(DecodeChunk, &Chunks[i]));
+	DecodeChunk(&Chunks[0]);
+	for (size_t i = 0; i < Workers.size(); i++) Workers[i].join();
+
+	for (int i = 0; i < Threads; i++) {
+		Events.insert(Events.end(), Chunks[i].Events.begin(), Chunks[i].Events.end());
+		Frames += Chunks[i].Frames;
+	}
+	Bytes += st.st_size;
+	munmap((void*)Data, st.st_size);
+	return true;
+}
+
+//*****************************************************************************
+// Output
+
+static void PrintTime(uint64_t Time) {
+	printf("%llu.%06llu", (unsigned long long)(Time / 1000000), (unsigned long long)(Time % 1000000));
+}
+
+static void PrintEvent(const tAlertEvent &Event) {
+	printf("  ");
+	PrintTime(Event.Time);
+	printf(" %3u ", Event.Source);
+	switch (Event.PGN) {
+		case 126983: {
+			const tN2kAlertNotification &n = Event.Notification;
+			printf("126983 %s, threshold %s, occurence %u, priority %u, silenced %s, acknowledged %s, escalated %s\n",
+				N2kEnumAlertTypeToStr(n.AlertState), N2kEnumAlertTypeToStr(n.ThresholdStatus), n.Key.AlertOccurence,
+				n.AlertPriority, N2kEnumAlertTypeToStr(n.TemporarySilenceStatus), N2kEnumAlertTypeToStr(n.AcknowledgeStatus),
+				N2kEnumAlertTypeToStr(n.EscalationStatus));
+			break;
+		}
+		case 126984: {
+			const tN2kAlertResponse &r = Event.Response;
+			printf("126984 %s by %016llx, occurence %u\n", N2kEnumAlertTypeToStr(r.ResponseCommand),
+				(unsigned long long)r.AcknowledgeNetworkID, r.Key.AlertOccurence);
+			break;
+		}
+		case 126985: {
+			const tN2kAlertText &t = Event.Text;
+			printf("126985 \"%s\" at \"%s\", %s\n", t.AlertTextDescription, t.AlertLocationTextDescription,
+				N2kEnumAlertTypeToStr(t.AlertLanguage));
+			break;
+		}
+	}
+}
+
+static bool EventOrder(const tAlertEvent* a, const tAlertEvent* b) {
+	return a->UID < b->UID;
+}
+
+static void PrintTimelines(const std::vector<tAlertEvent> &Events) {
+	std::vector<const tAlertEvent*> Order(Events.size());
+
+	for (size_t i = 0; i < Events.size(); i++) Order[i] = &Events[i];
+	std::stable_sort(Order.begin(), Order.end(), EventOrder);
+
+	for (size_t i = 0; i < Order.size(); i++) {
+		if ((i == 0) || (Order[i]->UID != Order[i - 1]->UID)) {
+			const tN2kAlertKey &Key = Order[i]->Notification.Key;	// Key is the first field of all records
+			printf("%sAlert %s/%s system %u/%u id %u source %016llx\n", (i == 0) ? "" : "\n",
+				N2kEnumAlertTypeToStr(Key.AlertType), N2kEnumAlertTypeToStr(Key.AlertCategory),
+				Key.AlertSystem, Key.AlertSubSystem, Key.AlertID, (unsigned long long)Key.SourceNetworkID);
+		}
+		PrintEvent(*Order[i]);
+	}
+}
+
+// Prints one column of a columnar export
+static int ScanColumn(const char* Name, const char* FileName) {
+	tN2kAlertColumnReader Reader;
+	std::vector<uint64_t> Values;
+	std::vector<uint32_t> Codes;
+	std::vector<tN2kAlertUID> UIDs;
+	std::vector<std::string> Texts;
+
+	if (!Reader.Open(FileName)) {
+		fprintf(stderr, "%s: not a column file\n", FileName);
+		return 1;
+	}
+	int Column = Reader.FindColumn(Name);
+	if (Column < 0) {
+		fprintf(stderr, "%s: no column %s\n", FileName, Name);
+		return 1;
+	}
+	switch (Reader.GetEncoding(Column)) {
+		case N2kAlertColumnDictUID:
+			if (!Reader.ReadUIDs(Column, Codes, UIDs)) break;
+			for (size_t i = 0; i < Codes.size(); i++) {
+				printf("%010llx %016llx\n", (unsigned long long)UIDs[Codes[i]].Code, (unsigned long long)UIDs[Codes[i]].SourceNetworkID);
+			}
+			return 0;
+		case N2kAlertColumnDictText:
+			if (!Reader.ReadTexts(Column, Codes, Texts)) break;
+			for (size_t i = 0; i < Codes.size(); i++) printf("%s\n", Texts[Codes[i]].c_str());
+			return 0;
+		default:
+			if (!Reader.ReadValues(Column, Values)) break;
+			for (size_t i = 0; i < Values.size(); i++) printf("%llu\n", (unsigned long long)Values[i]);
+			return 0;
+	}
+	fprintf(stderr, "%s: column %s is corrupt\n", FileName, Name);
+	return 1;
+}
+
+int main(int argc, char** argv) {
+	int Threads = std::thread::hardware_concurrency();
+	int Arg = 1;
+	const char* ExportFile = 0;
+	std::vector<tAlertEvent> Events;
+	uint64_t Bytes = 0;
+	uint64_t Frames = 0;
+	bool Result = true;
+
+	static char OutputBuffer[1 << 16];
+	setvbuf(stdout, OutputBuffer, _IOFBF, sizeof(OutputBuffer));
+
+	if ((argc == 4) && (strcmp(argv[1], "-s") == 0)) {
+		return ScanColumn(argv[2], argv[3]);
+	}
+	for (; (Arg + 1 < argc) && (argv[Arg][0] == '-'); Arg += 2) {
+		if (strcmp(argv[Arg], "-j") == 0) {
+			Threads = atoi(argv[Arg + 1]);
+		}
+		else if (strcmp(argv[Arg], "-x") == 0) {
+			ExportFile = argv[Arg + 1];
+		}
+		else {
+			break;
+		}
+	}
+	if (Threads < 1) Threads = 1;
+	if ((Arg >= argc) || (argv[Arg][0] == '-')) {
+		fprintf(stderr, "Usage: %s [-j threads] [-x export] log...\n       %s -s column export\n", argv[0], argv[0]);
+		return 2;
+	}
+
+	std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+	for (; Arg < argc; Arg++) {
+		Result &= DecodeFile(argv[Arg], Threads, Events, Bytes, Frames);
+	}
+	double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+	if (ExportFile != 0) {
+		if (!N2kAlertWriteColumns(ExportFile, Events)) {
+			fprintf(stderr, "%s: write failed\n", ExportFile);
+			Result = false;
+		}
+	}
+	else {
+		PrintTimelines(Events);
+		fflush(stdout);
+	}
+	fprintf(stderr, "%llu bytes, %llu alert frames, %llu alert messages in %.3f s (%.1f MB/s, %d threads)\n",
+		(unsigned long long)Bytes, (unsigned long long)Frames, (unsigned long long)Events.size(), Seconds,
+		(Seconds > 0) ? Bytes / Seconds / 1e6 : 0.0, Threads);
+	return Result ? 0 : 1;
+}
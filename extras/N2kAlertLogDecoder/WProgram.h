@@ -0,0 +1,20 @@
+// WProgram.h
+//
+// Minimal replacement of the Arduino header for host builds of the alert
+// library. Only needed by the tools in extras.
+
+#ifndef _N2KALERTHOSTWPROGRAM_h
+#define _N2KALERTHOSTWPROGRAM_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <N2kStream.h>
+
+typedef N2kStream Stream;
+
+#ifndef F
+#define F(str) str
+#endif
+
+#endif
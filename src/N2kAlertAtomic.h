@@ -0,0 +1,50 @@
+// N2kAlertAtomic.h
+
+#ifndef _N2KALERTATOMIC_h
+#define _N2KALERTATOMIC_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+// Atomic load and store of a single word shared between tasks or cores. Loads
+// have acquire and stores have release semantics, so data written before a
+// store is visible to a task that loads the stored value.
+//
+// AVR has no atomic access for words wider than 8 bits, so the access is done
+// with interrupts disabled.
+
+#if defined(__AVR__)
+#include <util/atomic.h>
+
+template<typename T> inline T N2kAlertAtomicLoad(const volatile T &Value) {
+	T Result;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { Result = Value; }
+	return Result;
+}
+
+template<typename T> inline void N2kAlertAtomicStore(volatile T &Destination, T Value) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { Destination = Value; }
+}
+
+inline void N2kAlertAtomicFenceAcquire() {
+	__asm__ __volatile__("" ::: "memory");
+}
+#else
+template<typename T> inline T N2kAlertAtomicLoad(const volatile T &Value) {
+	return __atomic_load_n(&Value, __ATOMIC_ACQUIRE);
+}
+
+template<typename T> inline void N2kAlertAtomicStore(volatile T &Destination, T Value) {
+	__atomic_store_n(&Destination, Value, __ATOMIC_RELEASE);
+}
+
+// Keeps plain loads before the fence from moving after a later load
+inline void N2kAlertAtomicFenceAcquire() {
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+#endif
+
+#endif
@@ -0,0 +1,65 @@
+//
+//
+//
+
+#include "N2kAlertBitGroup.h"
+
+tN2kAlertBitGroup::tN2kAlertBitGroup(uint8_t _EngineInstance) :
+	BoundBits(0),
+	Word(0),
+	Valid(false),
+	EngineInstance(_EngineInstance) {
+
+	for (uint8_t i = 0; i < 32; i++) Alerts[i] = 0;
+}
+
+void tN2kAlertBitGroup::SetAlert(uint8_t Bit, tN2kAlert &Alert) {
+	if (Bit >= 32) return;
+	Alerts[Bit] = &Alert;
+	BoundBits |= (uint32_t)1 << Bit;
+	if (Valid) Evaluate((uint32_t)1 << Bit);
+}
+
+void tN2kAlertBitGroup::ClearAlert(uint8_t Bit) {
+	if (Bit >= 32) return;
+	Alerts[Bit] = 0;
+	BoundBits &= ~((uint32_t)1 << Bit);
+}
+
+// One iteration per set bit, lowest bit first
+void tN2kAlertBitGroup::Evaluate(uint32_t Bits) {
+	Bits &= BoundBits;
+	while (Bits != 0) {
+		uint8_t Bit = __builtin_ctzl((unsigned long)Bits);
+		Alerts[Bit]->TestAlertCondition((Word >> Bit) & 1);
+		Bits &= Bits - 1;
+	}
+}
+
+void tN2kAlertBitGroup::Update(uint32_t _Word) {
+	uint32_t Changed = Valid ? (_Word ^ Word) : 0xffffffffUL;
+
+	Word = _Word;
+	Valid = true;
+	Evaluate(Changed);
+}
+
+void tN2kAlertBitGroup::Refresh() {
+	if (Valid) Evaluate(0xffffffffUL);
+}
+
+bool tN2kAlertBitGroup::HandleMsg(const tN2kMsg &N2kMsg) {
+	unsigned char Instance;
+	double OilPressure, OilTemperature, CoolantTemperature, AlternatorVoltage, FuelRate, EngineHours, CoolantPressure, FuelPressure;
+	int8_t Load, Torque;
+	tN2kEngineDiscreteStatus1 Status1;
+	tN2kEngineDiscreteStatus2 Status2;
+
+	if (N2kMsg.PGN != 127489L) return false;
+	if (!ParseN2kPGN127489(N2kMsg, Instance, OilPressure, OilTemperature, CoolantTemperature, AlternatorVoltage, FuelRate,
+		EngineHours, CoolantPressure, FuelPressure, Load, Torque, Status1, Status2)) return false;
+	if (Instance != EngineInstance) return false;
+
+	Update((uint32_t)Status1.Status | ((uint32_t)Status2.Status << 16));
+	return true;
+}
@@ -0,0 +1,81 @@
+// N2kAlertBitGroup.h
+
+#ifndef _N2KALERTBITGROUP_h
+#define _N2KALERTBITGROUP_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include <N2kMessages.h>
+#include "N2kAlerts.h"
+
+// Bits of the engine discrete status words of PGN 127489. Status 1 is in
+// bits 0-15, status 2 in bits 16-31.
+#define N2kAlertEngineCheckEngine 0
+#define N2kAlertEngineOverTemperature 1
+#define N2kAlertEngineLowOilPressure 2
+#define N2kAlertEngineLowOilLevel 3
+#define N2kAlertEngineLowFuelPressure 4
+#define N2kAlertEngineLowSystemVoltage 5
+#define N2kAlertEngineLowCoolantLevel 6
+#define N2kAlertEngineWaterFlow 7
+#define N2kAlertEngineWaterInFuel 8
+#define N2kAlertEngineChargeIndicator 9
+#define N2kAlertEnginePreheatIndicator 10
+#define N2kAlertEngineHighBoostPressure 11
+#define N2kAlertEngineRevLimitExceeded 12
+#define N2kAlertEngineEGRSystem 13
+#define N2kAlertEngineThrottlePositionSensor 14
+#define N2kAlertEngineEmergencyStopMode 15
+#define N2kAlertEngineWarningLevel1 16
+#define N2kAlertEngineWarningLevel2 17
+#define N2kAlertEnginePowerReduction 18
+#define N2kAlertEngineMaintenanceNeeded 19
+#define N2kAlertEngineCommError 20
+#define N2kAlertEngineSubOrSecondaryThrottle 21
+#define N2kAlertEngineNeutralStartProtect 22
+#define N2kAlertEngineShuttingDown 23
+
+// Maps the bits of a 32 bit status word to alerts, one alert per bit.
+//
+// Update() XORs the new word with the previous one and only evaluates the
+// alerts of the changed bits, so a message without changes costs one compare
+// and a message with n changed bits n alert updates.
+//
+//   tN2kAlertBitGroup EngineStatusAlerts(0);
+//   EngineStatusAlerts.SetAlert(N2kAlertEngineOverTemperature, OverTemperatureAlert);
+//   EngineStatusAlerts.SetAlert(N2kAlertEngineLowOilPressure, LowOilPressureAlert);
+//
+//   void HandleNMEA2000Msg(const tN2kMsg &N2kMsg) { EngineStatusAlerts.HandleMsg(N2kMsg); }
+//
+// Only changes update an alert, so a temporary silence ends at the next
+// change. Call Refresh() periodically to evaluate all bound alerts.
+class tN2kAlertBitGroup {
+public:
+	tN2kAlertBitGroup(uint8_t _EngineInstance = 0);
+
+	void SetAlert(uint8_t Bit, tN2kAlert &Alert);
+	void ClearAlert(uint8_t Bit);
+
+	void Update(uint32_t Word);
+	void Refresh();
+	uint32_t GetWord() const { return Word; }
+
+	// Updates from PGN 127489 of the engine instance. Returns true if the
+	// message was used.
+	bool HandleMsg(const tN2kMsg &N2kMsg);
+
+private:
+	tN2kAlert* Alerts[32];
+	uint32_t BoundBits;
+	uint32_t Word;
+	bool Valid;
+	uint8_t EngineInstance;
+
+	void Evaluate(uint32_t Bits);
+};
+
+#endif
@@ -0,0 +1,326 @@
+//
+//
+//
+
+#include <string.h>
+#include "N2kAlertCondition.h"
+
+enum tN2kAlertConditionOp {
+	N2kAlertOpConst = 0,		// int32_t follows, little endian
+	N2kAlertOpInput = 1,		// Input index follows
+	N2kAlertOpHold = 2,			// Hold index follows
+	N2kAlertOpNot = 3,
+	N2kAlertOpAnd = 4,
+	N2kAlertOpOr = 5,
+	N2kAlertOpLt = 6,
+	N2kAlertOpLe = 7,
+	N2kAlertOpGt = 8,
+	N2kAlertOpGe = 9,
+	N2kAlertOpEq = 10,
+	N2kAlertOpNe = 11
+};
+
+tN2kAlertCondition::tN2kAlertCondition(tN2kAlert &_Alert, tN2kAlertTimerWheel &_Wheel) :
+	Alert(_Alert),
+	Wheel(_Wheel),
+	Code(0),
+	CodeSize(0),
+	Inputs(0),
+	InputCount(0),
+	Holds(0),
+	HoldCount(0),
+	Result(false),
+	ErrorPosition(0) {
+}
+
+tN2kAlertCondition::~tN2kAlertCondition() {
+	Clear();
+}
+
+void tN2kAlertCondition::Clear() {
+	for (uint8_t i = 0; i < HoldCount; i++) Wheel.Cancel(Holds[i].Timer);
+	delete[] Code;
+	delete[] Inputs;
+	delete[] Holds;
+	Code = 0;
+	CodeSize = 0;
+	Inputs = 0;
+	InputCount = 0;
+	Holds = 0;
+	HoldCount = 0;
+	Result = false;
+}
+
+bool tN2kAlertCondition::Compile(const char* Expression, const char* const* InputNames, uint8_t _InputCount) {
+	tCompiler C;
+
+	Clear();
+	InputCount = _InputCount;
+	ErrorPosition = 0;
+
+	// Pass 1 sizes the code and the holds, pass 2 writes them
+	for (uint8_t Pass = 0; Pass < 2; Pass++) {
+		C.Start = Expression;
+		C.Pos = Expression;
+		C.InputNames = InputNames;
+		C.Code = Code;
+		C.CodeSize = 0;
+		C.Holds = Holds;
+		C.HoldCount = 0;
+		C.Depth = 0;
+		C.Error = false;
+
+		ParseOr(C);
+		SkipSpace(C);
+		if (*C.Pos != 0) C.Error = true;
+		if (C.Error) {
+			ErrorPosition = (uint16_t)(C.Pos - C.Start);
+			InputCount = 0;
+			return false;
+		}
+
+		if (Pass == 0) {
+			Code = new uint8_t[C.CodeSize];
+			Holds = new tHold[C.HoldCount > 0 ? C.HoldCount : 1];
+		}
+	}
+	CodeSize = C.CodeSize;
+	HoldCount = C.HoldCount;
+	for (uint8_t i = 0; i < HoldCount; i++) {
+		Holds[i].Timer.SetCallback(OnHoldTimer, this);
+		Holds[i].Since = 0;
+		Holds[i].Active = false;
+	}
+
+	Inputs = new int32_t[InputCount > 0 ? InputCount : 1];
+	for (uint8_t i = 0; i < InputCount; i++) Inputs[i] = 0;
+	Evaluate();
+	return true;
+}
+
+void tN2kAlertCondition::Emit(tCompiler &C, uint8_t Byte) {
+	if (C.CodeSize == 0xffff) {
+		C.Error = true;
+		return;
+	}
+	if (C.Code != 0) C.Code[C.CodeSize] = Byte;
+	C.CodeSize++;
+}
+
+void tN2kAlertCondition::EmitInt32(tCompiler &C, int32_t Value) {
+	for (uint8_t i = 0; i < 4; i++) Emit(C, (uint8_t)((uint32_t)Value >> (8 * i)));
+}
+
+void tN2kAlertCondition::Push(tCompiler &C) {
+	if (++C.Depth > N2kAlertConditionMaxStack) C.Error = true;
+}
+
+void tN2kAlertCondition::SkipSpace(tCompiler &C) {
+	while (*C.Pos == ' ' || *C.Pos == '\t' || *C.Pos == '\r' || *C.Pos == '\n') C.Pos++;
+}
+
+bool tN2kAlertCondition::Accept(tCompiler &C, const char* Token) {
+	size_t Len = strlen(Token);
+
+	SkipSpace(C);
+	if (strncmp(C.Pos, Token, Len) != 0) return false;
+	C.Pos += Len;
+	return true;
+}
+
+bool tN2kAlertCondition::ParseNumber(tCompiler &C, int32_t &Value) {
+	int64_t v = 0;
+
+	SkipSpace(C);
+	if (*C.Pos < '0' || *C.Pos > '9') return false;
+	while (*C.Pos >= '0' && *C.Pos <= '9') {
+		v = v * 10 + (*C.Pos - '0');
+		if (v > 0x7fffffffL) {
+			C.Error = true;
+			return false;
+		}
+		C.Pos++;
+	}
+	Value = (int32_t)v;
+	return true;
+}
+
+void tN2kAlertCondition::ParseOr(tCompiler &C) {
+	ParseAnd(C);
+	while (!C.Error && Accept(C, "||")) {
+		ParseAnd(C);
+		Emit(C, N2kAlertOpOr);
+		C.Depth--;
+	}
+}
+
+void tN2kAlertCondition::ParseAnd(tCompiler &C) {
+	ParseNot(C);
+	while (!C.Error && Accept(C, "&&")) {
+		ParseNot(C);
+		Emit(C, N2kAlertOpAnd);
+		C.Depth--;
+	}
+}
+
+void tN2kAlertCondition::ParseNot(tCompiler &C) {
+	SkipSpace(C);
+	if (C.Pos[0] == '!' && C.Pos[1] != '=') {
+		C.Pos++;
+		ParseNot(C);
+		Emit(C, N2kAlertOpNot);
+	} else {
+		ParseCompare(C);
+	}
+}
+
+void tN2kAlertCondition::ParseCompare(tCompiler &C) {
+	uint8_t Op;
+
+	ParsePrimary(C);
+	if (C.Error) return;
+	// Two character operators first
+	if (Accept(C, "<=")) Op = N2kAlertOpLe;
+	else if (Accept(C, ">=")) Op = N2kAlertOpGe;
+	else if (Accept(C, "==")) Op = N2kAlertOpEq;
+	else if (Accept(C, "!=")) Op = N2kAlertOpNe;
+	else if (Accept(C, "<")) Op = N2kAlertOpLt;
+	else if (Accept(C, ">")) Op = N2kAlertOpGt;
+	else return;
+	ParsePrimary(C);
+	Emit(C, Op);
+	C.Depth--;
+}
+
+void tN2kAlertCondition::ParsePrimary(tCompiler &C) {
+	int32_t Value;
+
+	SkipSpace(C);
+	if (Accept(C, "(")) {
+		ParseOr(C);
+		if (!C.Error && !Accept(C, ")")) C.Error = true;
+		return;
+	}
+	if (Accept(C, "-")) {
+		if (!ParseNumber(C, Value)) {
+			C.Error = true;
+			return;
+		}
+		Emit(C, N2kAlertOpConst);
+		EmitInt32(C, -Value);
+		Push(C);
+		return;
+	}
+	if (ParseNumber(C, Value)) {
+		Emit(C, N2kAlertOpConst);
+		EmitInt32(C, Value);
+		Push(C);
+		return;
+	}
+	if (C.Error) return;
+
+	const char* Name = C.Pos;
+	while ((*C.Pos >= 'a' && *C.Pos <= 'z') || (*C.Pos >= 'A' && *C.Pos <= 'Z') || *C.Pos == '_' ||
+		(C.Pos > Name && *C.Pos >= '0' && *C.Pos <= '9')) C.Pos++;
+	size_t Len = C.Pos - Name;
+	if (Len == 0) {
+		C.Error = true;
+		return;
+	}
+
+	if (Len == 4 && strncmp(Name, "hold", 4) == 0 && Accept(C, "(")) {
+		ParseOr(C);
+		if (C.Error) return;
+		if (!Accept(C, ",") || !ParseNumber(C, Value) || !Accept(C, ")") || C.HoldCount == 255) {
+			C.Error = true;
+			return;
+		}
+		if (C.Holds != 0) C.Holds[C.HoldCount].Duration = (uint32_t)Value;
+		Emit(C, N2kAlertOpHold);
+		Emit(C, C.HoldCount++);
+		return;
+	}
+
+	for (uint8_t i = 0; i < InputCount; i++) {
+		if (strlen(C.InputNames[i]) == Len && strncmp(C.InputNames[i], Name, Len) == 0) {
+			Emit(C, N2kAlertOpInput);
+			Emit(C, i);
+			Push(C);
+			return;
+		}
+	}
+	C.Pos = Name;
+	C.Error = true;
+}
+
+void tN2kAlertCondition::SetInput(uint8_t Index, int32_t Value) {
+	if (Index >= InputCount || Inputs[Index] == Value) return;
+	Inputs[Index] = Value;
+	Evaluate();
+}
+
+void tN2kAlertCondition::Evaluate() {
+	int32_t Stack[N2kAlertConditionMaxStack];
+	uint8_t sp = 0;
+	uint16_t pc = 0;
+	uint32_t Now = N2kMillis();
+
+	if (CodeSize == 0) return;
+
+	while (pc < CodeSize) {
+		uint8_t Op = Code[pc++];
+		switch (Op) {
+			case N2kAlertOpConst:
+				Stack[sp++] = (int32_t)((uint32_t)Code[pc] | ((uint32_t)Code[pc + 1] << 8) | ((uint32_t)Code[pc + 2] << 16) | ((uint32_t)Code[pc + 3] << 24));
+				pc += 4;
+				break;
+			case N2kAlertOpInput:
+				Stack[sp++] = Inputs[Code[pc++]];
+				break;
+			case N2kAlertOpHold: {
+				tHold &Hold = Holds[Code[pc++]];
+				if (Stack[sp - 1] == 0) {
+					Hold.Active = false;
+					Wheel.Cancel(Hold.Timer);
+					break;
+				}
+				if (!Hold.Active) {
+					Hold.Active = true;
+					Hold.Since = Now;
+				}
+				uint32_t Held = Now - Hold.Since;
+				if (Held >= Hold.Duration) {
+					Stack[sp - 1] = 1;
+				} else {
+					// Re-evaluated when the time is up
+					if (!Hold.Timer.IsActive()) Wheel.Start(Hold.Timer, Hold.Duration - Held);
+					Stack[sp - 1] = 0;
+				}
+				break;
+			}
+			case N2kAlertOpNot:
+				Stack[sp - 1] = (Stack[sp - 1] == 0);
+				break;
+			default:
+				sp--;
+				switch (Op) {
+					case N2kAlertOpAnd: Stack[sp - 1] = (Stack[sp - 1] != 0) && (Stack[sp] != 0); break;
+					case N2kAlertOpOr: Stack[sp - 1] = (Stack[sp - 1] != 0) || (Stack[sp] != 0); break;
+					case N2kAlertOpLt: Stack[sp - 1] = Stack[sp - 1] < Stack[sp]; break;
+					case N2kAlertOpLe: Stack[sp - 1] = Stack[sp - 1] <= Stack[sp]; break;
+					case N2kAlertOpGt: Stack[sp - 1] = Stack[sp - 1] > Stack[sp]; break;
+					case N2kAlertOpGe: Stack[sp - 1] = Stack[sp - 1] >= Stack[sp]; break;
+					case N2kAlertOpEq: Stack[sp - 1] = Stack[sp - 1] == Stack[sp]; break;
+					case N2kAlertOpNe: Stack[sp - 1] = Stack[sp - 1] != Stack[sp]; break;
+				}
+				break;
+		}
+	}
+
+	Result = (Stack[0] != 0);
+	Alert.TestAlertCondition(Result);
+}
+
+void tN2kAlertCondition::OnHoldTimer(tN2kAlertTimer &Timer, void* Context) {
+	((tN2kAlertCondition*)Context)->Evaluate();
+}
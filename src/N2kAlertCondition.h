@@ -0,0 +1,104 @@
+// N2kAlertCondition.h
+
+#ifndef _N2KALERTCONDITION_h
+#define _N2KALERTCONDITION_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include "N2kAlerts.h"
+#include "N2kAlertTimerWheel.h"
+
+#define N2kAlertConditionMaxStack 16
+
+// Alert condition combining several inputs. The expression is compiled once
+// into stack bytecode and evaluated again only when an input changes or a
+// hold time runs out, and the result is passed to TestAlertCondition().
+//
+// Grammar, with C precedence:
+//   expr    := and { "||" and }
+//   and     := not { "&&" not }
+//   not     := "!" not | compare
+//   compare := primary [ ("<" | "<=" | ">" | ">=" | "==" | "!=") primary ]
+//   primary := number | "-" number | input | "(" expr ")" | "hold" "(" expr "," ms ")"
+//
+// Inputs are int32_t values named at compile time, in the unit the caller
+// uses, e.g. 0 / 1 for switches or the output of a tN2kAlertFilter. Non zero
+// is true. hold(e, ms) is true when e has been true for ms; it runs on the
+// shared timer wheel, so its expiry is evaluated without polling.
+//
+//   const char* BilgeInputs[] = { "pump", "rise" };
+//   tN2kAlertCondition BilgeCondition(BilgeAlert, AlertTimers);
+//   BilgeCondition.Compile("hold(pump && rise > 0, 60000)", BilgeInputs, 2);
+//   on change: BilgeCondition.SetInput(0, PumpRunning);
+class tN2kAlertCondition {
+public:
+	tN2kAlertCondition(tN2kAlert &_Alert, tN2kAlertTimerWheel &_Wheel);
+	~tN2kAlertCondition();
+
+	tN2kAlertCondition(const tN2kAlertCondition&) = delete;
+	tN2kAlertCondition &operator=(const tN2kAlertCondition&) = delete;
+
+	// Returns false on a syntax error, an unknown input or a too deep
+	// expression; see GetErrorPosition(). All inputs start as 0.
+	bool Compile(const char* Expression, const char* const* InputNames, uint8_t _InputCount);
+	uint16_t GetErrorPosition() const { return ErrorPosition; }
+	uint16_t GetCodeSize() const { return CodeSize; }
+
+	void SetInput(uint8_t Index, int32_t Value);
+	int32_t GetInput(uint8_t Index) const { return Index < InputCount ? Inputs[Index] : 0; }
+	bool GetResult() const { return Result; }
+
+private:
+	struct tHold {
+		tN2kAlertTimer Timer;
+		uint32_t Duration;
+		uint32_t Since;
+		bool Active;
+	};
+
+	tN2kAlert &Alert;
+	tN2kAlertTimerWheel &Wheel;
+	uint8_t* Code;
+	uint16_t CodeSize;
+	int32_t* Inputs;
+	uint8_t InputCount;
+	tHold* Holds;
+	uint8_t HoldCount;
+	bool Result;
+	uint16_t ErrorPosition;
+
+	// Compiler state. The first pass only counts code and holds.
+	struct tCompiler {
+		const char* Start;
+		const char* Pos;
+		const char* const* InputNames;
+		uint8_t* Code;
+		uint16_t CodeSize;
+		tHold* Holds;
+		uint8_t HoldCount;
+		uint8_t Depth;
+		bool Error;
+	};
+
+	static void Emit(tCompiler &C, uint8_t Byte);
+	static void EmitInt32(tCompiler &C, int32_t Value);
+	static void Push(tCompiler &C);
+	static void SkipSpace(tCompiler &C);
+	static bool Accept(tCompiler &C, const char* Token);
+	static bool ParseNumber(tCompiler &C, int32_t &Value);
+	void ParseOr(tCompiler &C);
+	void ParseAnd(tCompiler &C);
+	void ParseNot(tCompiler &C);
+	void ParseCompare(tCompiler &C);
+	void ParsePrimary(tCompiler &C);
+	void Clear();
+
+	void Evaluate();
+	static void OnHoldTimer(tN2kAlertTimer &Timer, void* Context);
+};
+
+#endif
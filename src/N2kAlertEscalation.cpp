@@ -0,0 +1,68 @@
+//
+//
+//
+
+#include "N2kAlertEscalation.h"
+
+tN2kAlertEscalation::tN2kAlertEscalation(tN2kAlertTimerWheel &_Wheel, tN2kAlert &_Alert, const tN2kAlertEscalationStep* _Steps, uint8_t _StepCount) :
+	Wheel(_Wheel),
+	Alert(_Alert),
+	Steps(_Steps),
+	StepCount(_StepCount < 15 ? _StepCount : 15),
+	BaseType(_Alert.GetAlertType()),
+	Timer(OnTimer, this),
+	Attached(false) {
+}
+
+tN2kAlertEscalation::~tN2kAlertEscalation() {
+	Detach();
+}
+
+bool tN2kAlertEscalation::Attach() {
+	if (Attached) return true;
+	if (Alert.GetEscalationSupport() != N2kts_AlertYes) return false;
+	if (!Alert.AttachTransitionHandler(OnTransition, this)) return false;
+	BaseType = Alert.GetAlertType();
+	Attached = true;
+	Update();
+	return true;
+}
+
+void tN2kAlertEscalation::Detach() {
+	if (!Attached) return;
+	Alert.DetachTransitionHandler(OnTransition, this);
+	Wheel.Cancel(Timer);
+	Attached = false;
+}
+
+void tN2kAlertEscalation::OnTransition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus, void* Context) {
+	((tN2kAlertEscalation*)Context)->Update();
+}
+
+void tN2kAlertEscalation::OnTimer(tN2kAlertTimer &Timer, void* Context) {
+	((tN2kAlertEscalation*)Context)->Escalate();
+}
+
+// Called for every transition, also the ones made by SetEscalation()
+void tN2kAlertEscalation::Update() {
+	tN2kAlertStatus Status;
+
+	Alert.GetAlertStatus(Status);
+	if (Status.ThresholdStatus == N2kts_AlertThresholdStatusNormal) {
+		Wheel.Cancel(Timer);
+		if (Status.EscalationLevel > 0) Alert.SetEscalation(0, BaseType);
+		return;
+	}
+	if ((Status.AcknowledgeStatus == N2kts_AlertYes) || (Status.EscalationLevel >= StepCount)) {
+		Wheel.Cancel(Timer);
+		return;
+	}
+	if (!Timer.IsActive()) Wheel.Start(Timer, Steps[Status.EscalationLevel].Delay);
+}
+
+void tN2kAlertEscalation::Escalate() {
+	uint8_t Level = Alert.GetEscalationLevel();
+
+	if (Level >= StepCount) return;
+	Alert.SetEscalation(Level + 1, Steps[Level].AlertType);
+}
@@ -0,0 +1,65 @@
+// N2kAlertEscalation.h
+
+#ifndef _N2KALERTESCALATION_h
+#define _N2KALERTESCALATION_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include "N2kAlerts.h"
+#include "N2kAlertTimerWheel.h"
+
+// One step of an escalation ladder: after Delay ms without acknowledgement
+// the alert is escalated to AlertType
+struct tN2kAlertEscalationStep {
+	tN2kAlertType AlertType;
+	uint32_t Delay;
+};
+
+// Escalates an active, unacknowledged alert along a ladder of steps. Step n
+// sets escalation level n + 1 with tN2kAlert::SetEscalation(), which changes
+// the alert type and UID and is a transition, so an attached
+// tN2kAlertTransmitter sends the new 126983 at once, after a last normal one
+// for the previous type. Acknowledging stops the ladder at the reached level;
+// the alert returns to its own type when it goes back to normal. Only the
+// running step has a timer on the shared wheel.
+//
+//   const tN2kAlertEscalationStep BilgeLadder[] = {
+//       { N2kts_AlertTypeWarning, 60000 },
+//       { N2kts_AlertTypeAlarm, 120000 },
+//   };
+//   tN2kAlertEscalation BilgeEscalation(AlertTimers, BilgeAlert, BilgeLadder, 2);
+//   setup(): BilgeEscalation.Attach();
+//
+// The steps are referenced, not copied, and must stay valid.
+class tN2kAlertEscalation {
+public:
+	tN2kAlertEscalation(tN2kAlertTimerWheel &_Wheel, tN2kAlert &_Alert, const tN2kAlertEscalationStep* _Steps, uint8_t _StepCount);
+	~tN2kAlertEscalation();
+
+	// Returns false if the alert does not support escalation or has no free
+	// transition handler slot
+	bool Attach();
+	void Detach();
+
+	uint8_t GetLevel() { return Alert.GetEscalationLevel(); }
+
+private:
+	tN2kAlertTimerWheel &Wheel;
+	tN2kAlert &Alert;
+	const tN2kAlertEscalationStep* Steps;
+	uint8_t StepCount;
+	tN2kAlertType BaseType;
+	tN2kAlertTimer Timer;
+	bool Attached;
+
+	void Update();
+	void Escalate();
+	static void OnTransition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus, void* Context);
+	static void OnTimer(tN2kAlertTimer &Timer, void* Context);
+};
+
+#endif
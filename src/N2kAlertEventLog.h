@@ -0,0 +1,102 @@
+// N2kAlertEventLog.h
+
+#ifndef _N2KALERTEVENTLOG_h
+#define _N2KALERTEVENTLOG_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include "N2kAlerts.h"
+#include "N2kAlertAtomic.h"
+
+// One alert state change, 32 bytes
+struct tN2kAlertEvent {
+	tN2kAlertUID UID;		// Key of the alert at the time of the change
+	uint32_t Time;			// N2kMillis() of the change
+	uint32_t Value;			// Value passed to TestAlertThreshold, low 32 bits
+	uint8_t States;			// Old AlertState in bits 0-3, new AlertState in bits 4-7
+	uint8_t Occurence;
+
+	uint16_t GetAlertId() const { return (uint16_t)(UID.Code & 0xffff); }
+	tN2kAlertState GetOldState() const { return tN2kAlertState(States & 0x0f); }
+	tN2kAlertState GetNewState() const { return tN2kAlertState(States >> 4); }
+};
+
+// Ring buffer of the last alert events. When the ring is full the oldest
+// event is overwritten. The slot after the newest event is the next one to
+// be overwritten, so Size - 1 events can be read.
+//
+// Events are added from the transition handlers of the attached alerts, so
+// adding is O(1) and done by the task that owns the alerts. Other tasks can
+// read the log at the same time: GetEvent() returns false for an event that
+// was overwritten while it was read.
+//
+//   tN2kAlertEventLog<64> AlertLog;
+//   AlertLog.Attach(Alerts, AlertCount);
+//
+//   tN2kAlertEvent Event;
+//   for (uint32_t i = AlertLog.GetFirst(); i != AlertLog.GetEnd(); i++) {
+//     if (AlertLog.GetEvent(i, Event)) { ... }
+//   }
+template<uint16_t Size> class tN2kAlertEventLog {
+	static_assert((Size >= 2) && ((Size & (Size - 1)) == 0), "Size must be a power of two");
+
+public:
+	tN2kAlertEventLog() : End(0) {}
+
+	bool Attach(tN2kAlert** Alerts, uint16_t AlertCount) {
+		bool Result = true;
+		for (uint16_t i = 0; i < AlertCount; i++) {
+			Result &= Alerts[i]->AttachTransitionHandler(OnTransition, this);
+		}
+		return Result;
+	}
+
+	void Add(const tN2kAlertEvent &Event) {
+		uint32_t _End = End;
+		Events[_End & (Size - 1)] = Event;
+		N2kAlertAtomicStore(End, _End + 1);
+	}
+
+	void Add(tN2kAlert &Alert, tN2kAlertState OldState, tN2kAlertState NewState, uint8_t Occurence) {
+		tN2kAlertEvent Event;
+		Event.UID = Alert.GetAlertUID();
+		Event.Time = N2kMillis();
+		Event.Value = (uint32_t)Alert.GetLastValue();
+		Event.States = (OldState & 0x0f) | ((NewState & 0x0f) << 4);
+		Event.Occurence = Occurence;
+		Add(Event);
+	}
+
+	// Sequence numbers of the oldest readable event and one past the newest
+	// event
+	uint32_t GetFirst() const {
+		uint32_t _End = N2kAlertAtomicLoad(End);
+		return (_End > Size - 1) ? _End - (Size - 1) : 0;
+	}
+	uint32_t GetEnd() const { return N2kAlertAtomicLoad(End); }
+
+	// Add() overwrites the slot of Sequence End - Size before it publishes
+	// End + 1, so that event may be torn and is rejected
+	bool GetEvent(uint32_t Sequence, tN2kAlertEvent &Event) const {
+		if ((uint32_t)(N2kAlertAtomicLoad(End) - Sequence - 1) >= Size - 1) return false;
+		Event = Events[Sequence & (Size - 1)];
+		N2kAlertAtomicFenceAcquire();
+		return (uint32_t)(N2kAlertAtomicLoad(End) - Sequence) < Size;
+	}
+
+	void Clear() { N2kAlertAtomicStore(End, (uint32_t)0); }
+
+private:
+	tN2kAlertEvent Events[Size];
+	volatile uint32_t End;
+
+	static void OnTransition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus, void* Context) {
+		((tN2kAlertEventLog*)Context)->Add(Alert, OldStatus.AlertState, NewStatus.AlertState, NewStatus.Occurence);
+	}
+};
+
+#endif
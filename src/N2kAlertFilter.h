@@ -0,0 +1,104 @@
+// N2kAlertFilter.h
+
+#ifndef _N2KALERTFILTER_h
+#define _N2KALERTFILTER_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include <N2kTimer.h>
+#include "N2kAlerts.h"
+
+enum tN2kAlertFilterMode {
+	N2kAlertFilterMovingAverage = 0,	// Mean of the last Size samples
+	N2kAlertFilterEWMA = 1,				// Exponentially weighted, weight of a new sample 1/2^Shift
+	N2kAlertFilterRateOfChange = 2		// Change per second over the last Size samples
+};
+
+// Filtered alert condition. Samples are integers in the unit of the alert
+// threshold, e.g. 0.01 K, and the filtered value is passed to
+// TestAlertThreshold(). Everything is computed in integer arithmetic with
+// O(1) work per sample: the moving average keeps a running sum, the EWMA a
+// fixed point state with 8 fractional bits and the rate of change compares
+// the newest and oldest sample of the ring. The memory per filter is fixed by
+// Size, which must be a power of two.
+//
+// Negative results are passed as 0, like in tN2kAlertRouter. For an alert on
+// a falling value, e.g. a pressure drop, add the negated samples.
+//
+//   tN2kAlertFilter<8> ExhaustRise(ExhaustRiseAlert, N2kAlertFilterRateOfChange);
+//   on sample: ExhaustRise.Add(ExhaustTemperature);  // 0.01 K -> 0.01 K/s
+template<uint16_t Size> class tN2kAlertFilter {
+	static_assert((Size >= 2) && (Size <= 32768) && ((Size & (Size - 1)) == 0), "Size must be a power of two");
+
+public:
+	tN2kAlertFilter(tN2kAlert &_Alert, tN2kAlertFilterMode _Mode, uint8_t _Shift = 3) :
+		Alert(_Alert), Mode(_Mode), Shift(_Shift < 16 ? _Shift : 16) {
+		Reset();
+	}
+
+	void Reset() { Head = 0; Count = 0; Sum = 0; State = 0; Value = 0; }
+
+	tN2kAlertThresholdStatus Add(int32_t Sample) { return Add(Sample, N2kMillis()); }
+
+	// Time in ms, used by the rate of change
+	tN2kAlertThresholdStatus Add(int32_t Sample, uint32_t Time) {
+		if (Count == Size) {
+			Sum -= Samples[Head & (Size - 1)].Value;
+		} else {
+			Count++;
+		}
+		Samples[Head & (Size - 1)].Value = Sample;
+		Samples[Head & (Size - 1)].Time = Time;
+		Head++;
+		Sum += Sample;
+
+		switch (Mode) {
+			case N2kAlertFilterMovingAverage:
+				Value = Sum / Count;
+				break;
+			case N2kAlertFilterEWMA:
+				if (Count == 1) {
+					State = (int64_t)Sample * 256;
+				} else {
+					State += ((int64_t)Sample * 256 - State) / ((int32_t)1 << Shift);
+				}
+				Value = State / 256;
+				break;
+			case N2kAlertFilterRateOfChange: {
+				const tSample &Oldest = Samples[(uint16_t)(Head - Count) & (Size - 1)];
+				uint32_t Elapsed = Time - Oldest.Time;
+				// Needs two samples with time between them
+				if (Elapsed == 0) return Alert.GetAlertThresholdStatus();
+				Value = ((int64_t)Sample - Oldest.Value) * 1000 / (int64_t)Elapsed;
+				break;
+			}
+		}
+
+		return Alert.TestAlertThreshold(Value > 0 ? (uint64_t)Value : 0);
+	}
+
+	int64_t GetValue() const { return Value; }
+	uint16_t GetCount() const { return Count; }
+
+private:
+	struct tSample {
+		int32_t Value;
+		uint32_t Time;
+	};
+
+	tN2kAlert &Alert;
+	tN2kAlertFilterMode Mode;
+	uint8_t Shift;
+	tSample Samples[Size];
+	uint16_t Head;
+	uint16_t Count;
+	int64_t Sum;
+	int64_t State;
+	int64_t Value;
+};
+
+#endif
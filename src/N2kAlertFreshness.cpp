@@ -0,0 +1,49 @@
+//
+//
+//
+
+#include "N2kAlertFreshness.h"
+
+tN2kAlertFreshness::tN2kAlertFreshness(tN2kAlertTimerWheel &_Wheel, tN2kAlert &_Alert, uint32_t _Timeout, tN2kAlert* _LostAlert) :
+	Wheel(_Wheel),
+	Alert(_Alert),
+	LostAlert(_LostAlert),
+	Deadline(OnExpired, this),
+	Timeout(_Timeout),
+	Lost(false) {
+}
+
+tN2kAlertFreshness::~tN2kAlertFreshness() {
+	Wheel.Cancel(Deadline);
+}
+
+void tN2kAlertFreshness::Start() {
+	Wheel.Start(Deadline, Timeout);
+}
+
+void tN2kAlertFreshness::Stop() {
+	Wheel.Cancel(Deadline);
+	if (Lost && LostAlert != 0) LostAlert->TestAlertCondition(false);
+	Lost = false;
+}
+
+void tN2kAlertFreshness::Sample() {
+	Wheel.Start(Deadline, Timeout);
+	if (!Lost) return;
+	Lost = false;
+	if (LostAlert != 0) LostAlert->TestAlertCondition(false);
+}
+
+void tN2kAlertFreshness::OnExpired(tN2kAlertTimer &Timer, void* Context) {
+	((tN2kAlertFreshness*)Context)->Expired();
+}
+
+// The deadline is not restarted, a lost source costs nothing until it returns
+void tN2kAlertFreshness::Expired() {
+	Lost = true;
+	if (LostAlert != 0) {
+		LostAlert->TestAlertCondition(true);
+	} else {
+		Alert.TestAlertCondition(true);
+	}
+}
@@ -0,0 +1,57 @@
+// N2kAlertFreshness.h
+
+#ifndef _N2KALERTFRESHNESS_h
+#define _N2KALERTFRESHNESS_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include "N2kAlerts.h"
+#include "N2kAlertTimerWheel.h"
+
+// Data freshness deadline of an alert. Every sample restarts the deadline on
+// the shared timer wheel. If no sample arrives within Timeout ms, the source
+// is lost: the lost alert is raised with TestAlertCondition(true), and it is
+// cleared again by the next sample. Without a separate lost alert the alert
+// itself is raised, so a silent sensor fails to the alarm state.
+//
+//   tN2kAlertTimerWheel AlertTimers(64, 10);
+//   tN2kAlertFreshness EngineRoomFreshness(AlertTimers, EngineRoomAlert, 5000, &EngineRoomSensorLostAlert);
+//
+//   setup(): EngineRoomFreshness.Start();
+//   on sample: EngineRoomFreshness.TestAlertThreshold(Value);
+//   loop(): AlertTimers.Handle();
+class tN2kAlertFreshness {
+public:
+	tN2kAlertFreshness(tN2kAlertTimerWheel &_Wheel, tN2kAlert &_Alert, uint32_t _Timeout, tN2kAlert* _LostAlert = 0);
+	~tN2kAlertFreshness();
+
+	// Arms the first deadline, so a sensor that never sends is detected too
+	void Start();
+	void Stop();
+	void SetTimeout(uint32_t _Timeout) { Timeout = _Timeout; }
+
+	// Restarts the deadline. Call this for every sample also when the alert
+	// is tested some other way, e.g. by tN2kAlertRouter.
+	void Sample();
+	tN2kAlertThresholdStatus TestAlertThreshold(uint64_t v) { Sample(); return Alert.TestAlertThreshold(v); }
+	tN2kAlertThresholdStatus TestAlertCondition(bool Active) { Sample(); return Alert.TestAlertCondition(Active); }
+
+	bool isLost() const { return Lost; }
+
+private:
+	tN2kAlertTimerWheel &Wheel;
+	tN2kAlert &Alert;
+	tN2kAlert* LostAlert;
+	tN2kAlertTimer Deadline;
+	uint32_t Timeout;
+	bool Lost;
+
+	static void OnExpired(tN2kAlertTimer &Timer, void* Context);
+	void Expired();
+};
+
+#endif
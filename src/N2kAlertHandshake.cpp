@@ -0,0 +1,108 @@
+//
+//
+//
+
+#include "N2kAlertHandshake.h"
+
+tN2kAlertHandshake::tN2kAlertHandshake(tN2kAlertTimerWheel &_Wheel, tN2kAlertTransmitter &_Transmitter, tN2kAlert** _Alerts, uint16_t _AlertCount) :
+	Wheel(_Wheel),
+	Transmitter(_Transmitter),
+	Alerts(_Alerts),
+	AlertCount(_AlertCount),
+	InitialDelay(500),
+	MaxDelay(4000),
+	MaxRetries(10) {
+
+	Entries = new tEntry[AlertCount > 0 ? AlertCount : 1];
+	for (uint16_t i = 0; i < AlertCount; i++) {
+		Entries[i].Timer.SetCallback(OnTimer, &Entries[i]);
+		Entries[i].Owner = this;
+		Entries[i].Since = 0;
+		Entries[i].Delay = 0;
+		Entries[i].Latency = 0;
+		Entries[i].Retries = 0;
+		Entries[i].Awaiting = false;
+	}
+	ClearCounters();
+}
+
+tN2kAlertHandshake::~tN2kAlertHandshake() {
+	for (uint16_t i = 0; i < AlertCount; i++) {
+		Alerts[i]->DetachTransitionHandler(OnTransition, this);
+		Wheel.Cancel(Entries[i].Timer);
+	}
+	delete[] Entries;
+}
+
+bool tN2kAlertHandshake::Attach() {
+	bool Result = true;
+
+	for (uint16_t i = 0; i < AlertCount; i++) {
+		Result &= Alerts[i]->AttachTransitionHandler(OnTransition, this);
+	}
+	return Result;
+}
+
+void tN2kAlertHandshake::SetRetries(uint32_t _InitialDelay, uint32_t _MaxDelay, uint8_t _MaxRetries) {
+	InitialDelay = _InitialDelay;
+	MaxDelay = (_MaxDelay > _InitialDelay) ? _MaxDelay : _InitialDelay;
+	MaxRetries = _MaxRetries;
+}
+
+void tN2kAlertHandshake::ClearCounters() {
+	AcknowledgedCount = 0;
+	TimeoutCount = 0;
+	RetryCount = 0;
+	MaxLatency = 0;
+}
+
+void tN2kAlertHandshake::OnTransition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus, void* Context) {
+	((tN2kAlertHandshake*)Context)->Transition(Alert, OldStatus, NewStatus);
+}
+
+void tN2kAlertHandshake::OnTimer(tN2kAlertTimer &Timer, void* Context) {
+	tEntry &Entry = *(tEntry*)Context;
+	Entry.Owner->Retry(Entry);
+}
+
+// The wait starts on entering the awaiting state and ends with the
+// acknowledgement or when the alert leaves the state some other way
+void tN2kAlertHandshake::Transition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus) {
+	uint16_t i;
+
+	for (i = 0; (i < AlertCount) && (Alerts[i] != &Alert); i++);
+	if (i == AlertCount) return;
+	tEntry &Entry = Entries[i];
+
+	if ((NewStatus.AlertState == N2kts_AlertStateAwaitingAcknowledge) && (NewStatus.AcknowledgeStatus == N2kts_AlertNo)) {
+		if (Entry.Awaiting) return;
+		Entry.Awaiting = true;
+		Entry.Since = N2kMillis();
+		Entry.Delay = InitialDelay;
+		Entry.Retries = 0;
+		Wheel.Start(Entry.Timer, Entry.Delay);
+		return;
+	}
+
+	if (!Entry.Awaiting) return;
+	Entry.Awaiting = false;
+	Wheel.Cancel(Entry.Timer);
+	if ((NewStatus.AcknowledgeStatus == N2kts_AlertYes) && (OldStatus.AcknowledgeStatus == N2kts_AlertNo)) {
+		Entry.Latency = N2kMillis() - Entry.Since;
+		if (Entry.Latency > MaxLatency) MaxLatency = Entry.Latency;
+		AcknowledgedCount++;
+	}
+}
+
+void tN2kAlertHandshake::Retry(tEntry &Entry) {
+	if (Entry.Retries >= MaxRetries) {
+		// Stays awaiting, reported at the normal refresh rate
+		TimeoutCount++;
+		return;
+	}
+	Transmitter.Resend(*Alerts[&Entry - Entries]);
+	Entry.Retries++;
+	RetryCount++;
+	Entry.Delay = (Entry.Delay < MaxDelay / 2) ? Entry.Delay * 2 : MaxDelay;
+	Wheel.Start(Entry.Timer, Entry.Delay);
+}
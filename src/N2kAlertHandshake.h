@@ -0,0 +1,83 @@
+// N2kAlertHandshake.h
+
+#ifndef _N2KALERTHANDSHAKE_h
+#define _N2KALERTHANDSHAKE_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include "N2kAlerts.h"
+#include "N2kAlertTimerWheel.h"
+#include "N2kAlertTransmitter.h"
+
+// Acknowledge handshake for a list of alerts. An alert with acknowledge
+// support enters N2kts_AlertStateAwaitingAcknowledge when it becomes active.
+// While it waits, its 126983 is sent again by the transmitter after
+// InitialDelay ms, then with the delay doubled up to MaxDelay, until a
+// matching 126984 acknowledges it or MaxRetries resends were made. Between
+// resends only the timer of the alert sits on the shared wheel.
+//
+// Per alert the retries and the latency of the last acknowledgement are
+// kept, and over all alerts the acknowledgements, timeouts, retries and the
+// worst latency.
+//
+//   tN2kAlertHandshake AlertHandshake(AlertTimers, AlertTransmitter, Alerts, 2);
+//   setup(): AlertHandshake.Attach();
+class tN2kAlertHandshake {
+public:
+	tN2kAlertHandshake(tN2kAlertTimerWheel &_Wheel, tN2kAlertTransmitter &_Transmitter, tN2kAlert** _Alerts, uint16_t _AlertCount);
+	~tN2kAlertHandshake();
+
+	tN2kAlertHandshake(const tN2kAlertHandshake&) = delete;
+	tN2kAlertHandshake &operator=(const tN2kAlertHandshake&) = delete;
+
+	bool Attach();
+	void SetRetries(uint32_t _InitialDelay, uint32_t _MaxDelay, uint8_t _MaxRetries);
+
+	bool IsAwaiting(uint16_t Index) const { return Index < AlertCount && Entries[Index].Awaiting; }
+	uint8_t GetRetries(uint16_t Index) const { return Index < AlertCount ? Entries[Index].Retries : 0; }
+	// ms from the start of the wait to the acknowledgement
+	uint32_t GetLatency(uint16_t Index) const { return Index < AlertCount ? Entries[Index].Latency : 0; }
+
+	uint32_t GetAcknowledgedCount() const { return AcknowledgedCount; }
+	uint32_t GetTimeoutCount() const { return TimeoutCount; }
+	uint32_t GetRetryCount() const { return RetryCount; }
+	uint32_t GetMaxLatency() const { return MaxLatency; }
+	void ClearCounters();
+
+private:
+	struct tEntry {
+		tN2kAlertTimer Timer;
+		tN2kAlertHandshake* Owner;
+		uint32_t Since;
+		uint32_t Delay;
+		uint32_t Latency;
+		uint8_t Retries;
+		bool Awaiting;
+	};
+
+	tN2kAlertTimerWheel &Wheel;
+	tN2kAlertTransmitter &Transmitter;
+	tN2kAlert** Alerts;
+	uint16_t AlertCount;
+	tEntry* Entries;
+
+	uint32_t InitialDelay;
+	uint32_t MaxDelay;
+	uint8_t MaxRetries;
+
+	uint32_t AcknowledgedCount;
+	uint32_t TimeoutCount;
+	uint32_t RetryCount;
+	uint32_t MaxLatency;
+
+	void Transition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus);
+	void Retry(tEntry &Entry);
+	static void OnTransition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus, void* Context);
+	static void OnTimer(tN2kAlertTimer &Timer, void* Context);
+};
+
+#endif
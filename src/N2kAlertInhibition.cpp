@@ -0,0 +1,235 @@
+//
+//
+//
+
+#include "N2kAlertInhibition.h"
+
+tN2kAlertInhibition::tN2kAlertInhibition(tN2kAlert** _Alerts, uint16_t _AlertCount, const tN2kAlertInhibit* _Inhibits, uint16_t _InhibitCount) :
+	Alerts(_Alerts),
+	AlertCount(_AlertCount),
+	Inhibits(_Inhibits),
+	InhibitCount(_InhibitCount),
+	Order(0),
+	Rank(0),
+	ParentStart(0),
+	Parents(0),
+	ChildStart(0),
+	Children(0),
+	ByAddress(0),
+	Queue(0),
+	QueueSize(0),
+	Queued(0),
+	Propagating(false) {
+}
+
+tN2kAlertInhibition::~tN2kAlertInhibition() {
+	if (Order != 0) {
+		for (uint16_t i = 0; i < AlertCount; i++) Alerts[i]->DetachTransitionHandler(OnTransition, this);
+	}
+	Free();
+}
+
+void tN2kAlertInhibition::Free() {
+	delete[] Order;
+	delete[] Rank;
+	delete[] ParentStart;
+	delete[] Parents;
+	delete[] ChildStart;
+	delete[] Children;
+	delete[] ByAddress;
+	delete[] Queue;
+	delete[] Queued;
+	Order = 0;
+	Rank = 0;
+	ParentStart = 0;
+	Parents = 0;
+	ChildStart = 0;
+	Children = 0;
+	ByAddress = 0;
+	Queue = 0;
+	Queued = 0;
+}
+
+// Binary search in the alert indexes sorted by alert address
+int tN2kAlertInhibition::FindAlert(const tN2kAlert* Alert) const {
+	uint16_t First = 0;
+	uint16_t Last = AlertCount;
+
+	while (First < Last) {
+		uint16_t Middle = First + (Last - First) / 2;
+		if ((uintptr_t)Alerts[ByAddress[Middle]] < (uintptr_t)Alert) {
+			First = Middle + 1;
+		}
+		else {
+			Last = Middle;
+		}
+	}
+	return ((First < AlertCount) && (Alerts[ByAddress[First]] == Alert)) ? ByAddress[First] : -1;
+}
+
+bool tN2kAlertInhibition::Begin() {
+	uint16_t* Fill;
+	uint16_t* InDegree;
+	uint16_t Head = 0;
+	uint16_t Tail = 0;
+	bool Result = true;
+
+	if (Order != 0) return true;
+
+	Order = new uint16_t[AlertCount + 1];
+	Rank = new uint16_t[AlertCount + 1];
+	ParentStart = new uint16_t[AlertCount + 1];
+	Parents = new uint16_t[InhibitCount + 1];
+	ChildStart = new uint16_t[AlertCount + 1];
+	Children = new uint16_t[InhibitCount + 1];
+	ByAddress = new uint16_t[AlertCount + 1];
+	Queue = new uint16_t[AlertCount + 1];
+	Queued = new uint8_t[AlertCount + 1];
+	Fill = new uint16_t[AlertCount + 1];
+	InDegree = new uint16_t[AlertCount + 1];
+
+	// Insertion sort, done once
+	for (uint16_t i = 0; i < AlertCount; i++) {
+		uint16_t j = i;
+		for (; (j > 0) && ((uintptr_t)Alerts[ByAddress[j - 1]] > (uintptr_t)Alerts[i]); j--) ByAddress[j] = ByAddress[j - 1];
+		ByAddress[j] = i;
+	}
+	for (uint16_t i = 0; i < InhibitCount; i++) {
+		if ((FindAlert(Inhibits[i].Parent) < 0) || (FindAlert(Inhibits[i].Child) < 0)) Result = false;
+	}
+
+	if (Result) {
+		// Parent and child lists as offsets into one array per direction
+		for (uint16_t i = 0; i <= AlertCount; i++) {
+			ParentStart[i] = 0;
+			ChildStart[i] = 0;
+		}
+		for (uint16_t i = 0; i < InhibitCount; i++) {
+			ParentStart[FindAlert(Inhibits[i].Child) + 1]++;
+			ChildStart[FindAlert(Inhibits[i].Parent) + 1]++;
+		}
+		for (uint16_t i = 0; i < AlertCount; i++) {
+			ParentStart[i + 1] += ParentStart[i];
+			ChildStart[i + 1] += ChildStart[i];
+		}
+		for (uint16_t i = 0; i < AlertCount; i++) Fill[i] = ParentStart[i];
+		for (uint16_t i = 0; i < InhibitCount; i++) Parents[Fill[FindAlert(Inhibits[i].Child)]++] = FindAlert(Inhibits[i].Parent);
+		for (uint16_t i = 0; i < AlertCount; i++) Fill[i] = ChildStart[i];
+		for (uint16_t i = 0; i < InhibitCount; i++) Children[Fill[FindAlert(Inhibits[i].Parent)]++] = FindAlert(Inhibits[i].Child);
+
+		// Kahn's algorithm, Order is used as the queue
+		for (uint16_t i = 0; i < AlertCount; i++) {
+			InDegree[i] = ParentStart[i + 1] - ParentStart[i];
+			Queued[i] = 0;
+			if (InDegree[i] == 0) Order[Tail++] = i;
+		}
+		while (Head < Tail) {
+			uint16_t i = Order[Head++];
+			for (uint16_t c = ChildStart[i]; c < ChildStart[i + 1]; c++) {
+				if (--InDegree[Children[c]] == 0) Order[Tail++] = Children[c];
+			}
+		}
+		for (uint16_t k = 0; k < Tail; k++) Rank[Order[k]] = k;
+
+		Result = (Tail == AlertCount);
+		for (uint16_t i = 0; Result && (i < AlertCount); i++) {
+			if (ChildStart[i + 1] > ChildStart[i]) Result &= Alerts[i]->AttachTransitionHandler(OnTransition, this);
+		}
+	}
+
+	delete[] Fill;
+	delete[] InDegree;
+
+	if (!Result) {
+		for (uint16_t i = 0; i < AlertCount; i++) Alerts[i]->DetachTransitionHandler(OnTransition, this);
+		Free();
+		return false;
+	}
+
+	Update();
+	return true;
+}
+
+// Recomputes all alerts in topological order
+void tN2kAlertInhibition::Update() {
+	if (Order == 0) return;
+	Propagating = true;
+	for (uint16_t k = 0; k < AlertCount; k++) {
+		if (ParentStart[Order[k]] != ParentStart[Order[k] + 1]) Recompute(Order[k]);
+	}
+	Propagating = false;
+}
+
+bool tN2kAlertInhibition::IsInhibiting(uint16_t Index) {
+	return Alerts[Index]->isAlert() || Alerts[Index]->isInhibited();
+}
+
+// Returns true when the inhibiting state of the alert changed
+bool tN2kAlertInhibition::Recompute(uint16_t Index) {
+	bool Inhibit = false;
+
+	for (uint16_t p = ParentStart[Index]; !Inhibit && (p < ParentStart[Index + 1]); p++) {
+		Inhibit = IsInhibiting(Parents[p]);
+	}
+	if (Inhibit == Alerts[Index]->isInhibited()) return false;
+
+	bool WasInhibiting = IsInhibiting(Index);
+	Alerts[Index]->SetInhibited(Inhibit);
+	return IsInhibiting(Index) != WasInhibiting;
+}
+
+// Queue is a binary min-heap of topological ranks
+void tN2kAlertInhibition::QueueChildren(uint16_t Index) {
+	for (uint16_t c = ChildStart[Index]; c < ChildStart[Index + 1]; c++) {
+		uint16_t Child = Children[c];
+		uint16_t i = QueueSize;
+
+		if (Queued[Child]) continue;
+		Queued[Child] = 1;
+		QueueSize++;
+		for (; (i > 0) && (Queue[(i - 1) / 2] > Rank[Child]); i = (i - 1) / 2) Queue[i] = Queue[(i - 1) / 2];
+		Queue[i] = Rank[Child];
+	}
+}
+
+uint16_t tN2kAlertInhibition::DequeueFirst() {
+	uint16_t First = Order[Queue[0]];
+	uint16_t Last = Queue[--QueueSize];
+	uint16_t i = 0;
+
+	while (2 * i + 1 < QueueSize) {
+		uint16_t Child = 2 * i + 1;
+		if ((Child + 1 < QueueSize) && (Queue[Child + 1] < Queue[Child])) Child++;
+		if (Queue[Child] >= Last) break;
+		Queue[i] = Queue[Child];
+		i = Child;
+	}
+	Queue[i] = Last;
+	Queued[First] = 0;
+	return First;
+}
+
+// Visits the descendants of the changed alert in topological order. An alert
+// is recomputed after all its parents, and only its inhibiting state change
+// queues its own children.
+void tN2kAlertInhibition::Propagate(uint16_t Index) {
+	Propagating = true;
+	QueueChildren(Index);
+	while (QueueSize > 0) {
+		uint16_t i = DequeueFirst();
+		if (Recompute(i)) QueueChildren(i);
+	}
+	Propagating = false;
+}
+
+// Only a change of the threshold status changes isAlert() of a parent.
+// Inhibiting parents are changed by Propagate() itself.
+void tN2kAlertInhibition::OnTransition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus, void* Context) {
+	tN2kAlertInhibition* Inhibition = (tN2kAlertInhibition*)Context;
+
+	if (Inhibition->Propagating) return;
+	if ((OldStatus.ThresholdStatus != N2kts_AlertThresholdStatusNormal) == (NewStatus.ThresholdStatus != N2kts_AlertThresholdStatusNormal)) return;
+
+	int Index = Inhibition->FindAlert(&Alert);
+	if (Index >= 0) Inhibition->Propagate(Index);
+}
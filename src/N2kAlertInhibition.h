@@ -0,0 +1,82 @@
+// N2kAlertInhibition.h
+
+#ifndef _N2KALERTINHIBITION_h
+#define _N2KALERTINHIBITION_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include "N2kAlerts.h"
+
+// Parent inhibits Child while Parent is in alert or itself inhibited
+struct tN2kAlertInhibit {
+	tN2kAlert* Parent;
+	tN2kAlert* Child;
+};
+
+// Suppresses alerts that are only a consequence of another alert, e.g. low oil
+// pressure and alternator alerts while an "engine stopped" alert is active.
+// Inhibited alerts are reset to normal and not evaluated by
+// TestAlertThreshold(), so they cost neither CPU time nor bus traffic.
+//
+// Begin() sorts the alerts topologically once. When a parent enters or leaves
+// the alert condition, its transition handler propagates the change in that
+// order through its descendants only, and stops at alerts whose inhibiting
+// state does not change. Every alert is updated after all its parents and at
+// most once per change. Silence, acknowledge and other transitions that cannot
+// change inhibition are ignored.
+//
+//   tN2kAlert* Alerts[] = { &EngineStoppedAlert, &OilPressureAlert, &CoolantFlowAlert };
+//   const tN2kAlertInhibit Inhibits[] = {
+//     { &EngineStoppedAlert, &OilPressureAlert },
+//     { &EngineStoppedAlert, &CoolantFlowAlert },
+//   };
+//   tN2kAlertInhibition AlertInhibition(Alerts, 3, Inhibits, 2);
+//
+//   setup(): AlertInhibition.Begin();
+class tN2kAlertInhibition {
+public:
+	tN2kAlertInhibition(tN2kAlert** _Alerts, uint16_t _AlertCount, const tN2kAlertInhibit* _Inhibits, uint16_t _InhibitCount);
+	~tN2kAlertInhibition();
+
+	tN2kAlertInhibition(const tN2kAlertInhibition&) = delete;
+	tN2kAlertInhibition &operator=(const tN2kAlertInhibition&) = delete;
+
+	// Returns false if an alert of an inhibit is not in the alert list or the
+	// inhibits contain a cycle
+	bool Begin();
+	// Recomputes all alerts, e.g. after the state was restored
+	void Update();
+
+private:
+	tN2kAlert** Alerts;
+	uint16_t AlertCount;
+	const tN2kAlertInhibit* Inhibits;
+	uint16_t InhibitCount;
+
+	uint16_t* Order;		// Alert indexes in topological order
+	uint16_t* Rank;			// Position of alert i in Order
+	uint16_t* ParentStart;	// Parents of alert i are Parents[ParentStart[i] .. ParentStart[i + 1] - 1]
+	uint16_t* Parents;
+	uint16_t* ChildStart;	// Children of alert i, as the parents
+	uint16_t* Children;
+	uint16_t* ByAddress;	// Alert indexes sorted by alert address, for FindAlert()
+	uint16_t* Queue;		// Ranks of the alerts to recompute, see Propagate()
+	uint16_t QueueSize;
+	uint8_t* Queued;
+	bool Propagating;
+
+	void Free();
+	int FindAlert(const tN2kAlert* Alert) const;
+	bool IsInhibiting(uint16_t Index);
+	bool Recompute(uint16_t Index);
+	void QueueChildren(uint16_t Index);
+	uint16_t DequeueFirst();
+	void Propagate(uint16_t Index);
+	static void OnTransition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus, void* Context);
+};
+
+#endif
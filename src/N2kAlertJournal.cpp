@@ -0,0 +1,374 @@
+//
+//
+//
+
+#include "N2kAlertJournal.h"
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <chrono>
+#include <map>
+
+static_assert(sizeof(tN2kAlertJournalRecord) == 48, "Journal records must have a fixed layout");
+
+static const char N2kAlertJournalMagic[8] = { 'N', '2', 'K', 'A', 'J', 'R', 'N', '1' };
+#define N2kAlertJournalHeaderSize 16
+
+static uint32_t JournalCrc(const tN2kAlertJournalRecord &Record) {
+	const uint8_t* Data = (const uint8_t*)&Record;
+	uint32_t Crc = 0xffffffffUL;
+
+	for (size_t i = 0; i < offsetof(tN2kAlertJournalRecord, Crc); i++) {
+		Crc ^= Data[i];
+		for (uint8_t j = 0; j < 8; j++) {
+			Crc = (Crc >> 1) ^ (0xEDB88320UL & (0 - (Crc & 1)));
+		}
+	}
+	return ~Crc;
+}
+
+// Escalation changes the alert type in the code, so records are matched to
+// alerts without it
+static tN2kAlertUID JournalAlertKey(uint64_t AlertCode, uint64_t SourceNetworkID) {
+	tN2kAlertUID UID;
+	UID.Code = AlertCode & ~((uint64_t)0xf << 32);
+	UID.SourceNetworkID = SourceNetworkID;
+	return UID;
+}
+
+static uint64_t JournalTime() {
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+tN2kAlertJournal::tN2kAlertJournal() :
+	File(-1),
+	Sequence(0),
+	CommittedCount(0),
+	ErrorCount(0),
+	LostCount(0),
+	GroupSize(256),
+	GroupTime(100),
+	MaxPending(65536),
+	LastTime(0),
+	Stop(false),
+	FlushRequested(false) {
+}
+
+tN2kAlertJournal::~tN2kAlertJournal() {
+	Close();
+}
+
+// Records are synced to disk when GroupSize records are pending or GroupTime
+// ms after the first pending record, whichever comes first.
+void tN2kAlertJournal::SetGroupCommit(size_t _GroupSize, uint32_t _GroupTime) {
+	std::lock_guard<std::mutex> Guard(Lock);
+	GroupSize = (_GroupSize > 0) ? _GroupSize : 1;
+	GroupTime = _GroupTime;
+}
+
+// Limit of the records waiting to be written. Records appended above it are
+// dropped and counted in GetLostCount().
+void tN2kAlertJournal::SetMaxPending(size_t _MaxPending) {
+	std::lock_guard<std::mutex> Guard(Lock);
+	MaxPending = (_MaxPending > 0) ? _MaxPending : 1;
+}
+
+bool tN2kAlertJournal::Open(const char* FileName) {
+	char Header[N2kAlertJournalHeaderSize];
+	tN2kAlertJournalRecord Record;
+	off_t Size;
+	uint64_t Count;
+
+	if (IsOpen()) return false;
+	File = open(FileName, O_RDWR | O_CREAT, 0644);
+	if (File < 0) return false;
+
+	Size = lseek(File, 0, SEEK_END);
+	if (Size < N2kAlertJournalHeaderSize) {
+		memset(Header, 0, sizeof(Header));
+		memcpy(Header, N2kAlertJournalMagic, sizeof(N2kAlertJournalMagic));
+		Header[8] = sizeof(tN2kAlertJournalRecord);
+		if ((ftruncate(File, 0) != 0) || (pwrite(File, Header, sizeof(Header), 0) != sizeof(Header)) || (fdatasync(File) != 0)) {
+			close(File);
+			File = -1;
+			return false;
+		}
+		Size = N2kAlertJournalHeaderSize;
+	}
+	else if ((pread(File, Header, sizeof(Header), 0) != sizeof(Header)) || (memcmp(Header, N2kAlertJournalMagic, sizeof(N2kAlertJournalMagic)) != 0) ||
+		(Header[8] != sizeof(tN2kAlertJournalRecord))) {
+		close(File);
+		File = -1;
+		return false;
+	}
+
+	// A crash during a write can leave a partial or corrupt record at the end
+	Count = (Size - N2kAlertJournalHeaderSize) / sizeof(tN2kAlertJournalRecord);
+	while ((Count > 0) && (!ReadAt(Count - 1, Record) || (Record.Crc != JournalCrc(Record)))) Count--;
+	if (ftruncate(File, N2kAlertJournalHeaderSize + Count * sizeof(tN2kAlertJournalRecord)) != 0) {
+		close(File);
+		File = -1;
+		return false;
+	}
+	lseek(File, 0, SEEK_END);
+	Sequence = (Count > 0) ? Record.Sequence + 1 : 0;
+	LastTime = (Count > 0) ? Record.Time : 0;
+	CommittedCount = Count;
+
+	Stop = false;
+	Writer = std::thread(&tN2kAlertJournal::WriterThread, this);
+	return true;
+}
+
+void tN2kAlertJournal::Close() {
+	if (!IsOpen()) return;
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		Stop = true;
+	}
+	Wakeup.notify_all();
+	Writer.join();
+	close(File);
+	File = -1;
+}
+
+bool tN2kAlertJournal::Attach(tN2kAlert** Alerts, uint16_t AlertCount) {
+	bool Result = true;
+	for (uint16_t i = 0; i < AlertCount; i++) {
+		Result &= Alerts[i]->AttachTransitionHandler(OnTransition, this);
+	}
+	return Result;
+}
+
+void tN2kAlertJournal::OnTransition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus, void* Context) {
+	((tN2kAlertJournal*)Context)->AppendTransition(Alert, OldStatus, NewStatus);
+}
+
+void tN2kAlertJournal::Append(tN2kAlertJournalRecord &Record) {
+	bool Notify;
+
+	if (!IsOpen()) return;
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		if (Pending.size() >= MaxPending) {
+			LostCount++;
+			return;
+		}
+		// Keeps the times sorted for FindTime()
+		if (Record.Time < LastTime) Record.Time = LastTime;
+		LastTime = Record.Time;
+		Record.Sequence = Sequence++;
+		Pending.push_back(Record);
+		Notify = (Pending.size() == 1) || (Pending.size() >= GroupSize);
+	}
+	if (Notify) Wakeup.notify_one();
+}
+
+void tN2kAlertJournal::AppendTransition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus) {
+	tN2kAlertJournalRecord Record;
+
+	memset(&Record, 0, sizeof(Record));
+	Record.Time = JournalTime();
+	Record.AlertCode = Alert.GetAlertUID().Code;
+	Record.SourceNetworkID = Alert.GetAlertUID().SourceNetworkID;
+	Record.Value = (uint32_t)Alert.GetLastValue();
+	Record.Type = N2kAlertJournalTransition;
+	Record.States = (OldStatus.AlertState & 0x0f) | ((NewStatus.AlertState & 0x0f) << 4);
+	Record.Occurence = NewStatus.Occurence;
+	Record.Flags = (NewStatus.ThresholdStatus & 0x0f) << 4;
+	if (NewStatus.AcknowledgeStatus == N2kts_AlertYes) Record.Flags |= N2kAlertSnapshotFlagAcknowledged;
+	if (NewStatus.TemporarySilenceStatus == N2kts_AlertYes) Record.Flags |= N2kAlertSnapshotFlagSilenced;
+	if (NewStatus.EscalationStatus == N2kts_AlertYes) Record.Flags |= N2kAlertSnapshotFlagEscalated;
+	Append(Record);
+}
+
+void tN2kAlertJournal::AppendResponse(const tN2kAlertResponse &AlertResponse) {
+	tN2kAlertJournalRecord Record;
+
+	memset(&Record, 0, sizeof(Record));
+	Record.Time = JournalTime();
+	Record.AlertCode = AlertResponse.Key.UID.Code;
+	Record.SourceNetworkID = AlertResponse.Key.UID.SourceNetworkID;
+	Record.AcknowledgeNetworkID = AlertResponse.AcknowledgeNetworkID;
+	Record.Type = N2kAlertJournalResponse;
+	Record.States = AlertResponse.ResponseCommand;
+	Record.Occurence = AlertResponse.Key.AlertOccurence;
+	Append(Record);
+}
+
+// Journals every 126984 alert response
+bool tN2kAlertJournal::HandleMsg(const tN2kMsg &N2kMsg) {
+	tN2kAlertResponse AlertResponse;
+
+	if (!ParseN2kAlertResponse(N2kMsg, AlertResponse)) return false;
+	AppendResponse(AlertResponse);
+	return true;
+}
+
+// Waits until all appended records are on disk
+void tN2kAlertJournal::Flush() {
+	std::unique_lock<std::mutex> Guard(Lock);
+
+	if (!IsOpen()) return;
+	FlushRequested = true;
+	Wakeup.notify_one();
+	Committed.wait(Guard, [this] { return Pending.empty() && Writing.empty(); });
+}
+
+void tN2kAlertJournal::WriterThread() {
+	std::unique_lock<std::mutex> Guard(Lock);
+	std::chrono::steady_clock::time_point FirstPending = std::chrono::steady_clock::now();
+	bool WasEmpty = true;
+
+	while (true) {
+		if (Pending.empty()) {
+			if (Stop) break;
+			WasEmpty = true;
+			Wakeup.wait(Guard);
+			continue;
+		}
+		if (WasEmpty) {
+			FirstPending = std::chrono::steady_clock::now();
+			WasEmpty = false;
+		}
+		if ((Pending.size() < GroupSize) && !Stop && !FlushRequested &&
+			(std::chrono::steady_clock::now() < FirstPending + std::chrono::milliseconds(GroupTime))) {
+			Wakeup.wait_until(Guard, FirstPending + std::chrono::milliseconds(GroupTime));
+			continue;
+		}
+
+		Writing.swap(Pending);
+		FlushRequested = false;
+		WasEmpty = true;
+		// Only this thread changes CommittedCount
+		off_t CommittedSize = N2kAlertJournalHeaderSize + CommittedCount * sizeof(tN2kAlertJournalRecord);
+		Guard.unlock();
+
+		for (size_t i = 0; i < Writing.size(); i++) {
+			Writing[i].Crc = JournalCrc(Writing[i]);
+		}
+		bool Ok = WriteAt(CommittedSize, Writing.data(), Writing.size() * sizeof(tN2kAlertJournalRecord)) && (fdatasync(File) == 0);
+		// A failed batch is cut off again, so the records stay aligned and the
+		// next batch is written at the same offset
+		if (!Ok) {
+			while ((ftruncate(File, CommittedSize) != 0) && (errno == EINTR));
+		}
+
+		Guard.lock();
+		if (Ok) {
+			CommittedCount += Writing.size();
+		}
+		else {
+			ErrorCount++;
+			LostCount += Writing.size();
+		}
+		Writing.clear();
+		Committed.notify_all();
+	}
+}
+
+bool tN2kAlertJournal::WriteAt(off_t Offset, const void* Data, size_t Size) {
+	const uint8_t* Bytes = (const uint8_t*)Data;
+
+	while (Size > 0) {
+		ssize_t Written = pwrite(File, Bytes, Size, Offset);
+		if (Written < 0) {
+			if (errno == EINTR) continue;
+			return false;
+		}
+		if (Written == 0) return false;
+		Bytes += Written;
+		Size -= Written;
+		Offset += Written;
+	}
+	return true;
+}
+
+bool tN2kAlertJournal::ReadAt(uint64_t Index, tN2kAlertJournalRecord &Record) {
+	off_t Offset = N2kAlertJournalHeaderSize + Index * sizeof(tN2kAlertJournalRecord);
+	return pread(File, &Record, sizeof(Record), Offset) == sizeof(Record);
+}
+
+uint64_t tN2kAlertJournal::GetRecordCount() {
+	std::lock_guard<std::mutex> Guard(Lock);
+	return CommittedCount;
+}
+
+uint32_t tN2kAlertJournal::GetErrorCount() {
+	std::lock_guard<std::mutex> Guard(Lock);
+	return ErrorCount;
+}
+
+uint64_t tN2kAlertJournal::GetLostCount() {
+	std::lock_guard<std::mutex> Guard(Lock);
+	return LostCount;
+}
+
+bool tN2kAlertJournal::ReadRecord(uint64_t Index, tN2kAlertJournalRecord &Record) {
+	if (!IsOpen() || (Index >= GetRecordCount())) return false;
+	return ReadAt(Index, Record) && (Record.Crc == JournalCrc(Record));
+}
+
+// Index of the first record with a time at or after Time. Record times are
+// non-decreasing, see Append().
+uint64_t tN2kAlertJournal::FindTime(uint64_t Time) {
+	tN2kAlertJournalRecord Record;
+	uint64_t First = 0;
+	uint64_t Last = GetRecordCount();
+
+	while (First < Last) {
+		uint64_t Middle = First + (Last - First) / 2;
+		if (ReadAt(Middle, Record) && (Record.Time < Time)) {
+			First = Middle + 1;
+		}
+		else {
+			Last = Middle;
+		}
+	}
+	return First;
+}
+
+// Restores the last journaled state of each alert. Returns the number of
+// alerts restored.
+uint16_t tN2kAlertJournal::Replay(tN2kAlert** Alerts, uint16_t AlertCount) {
+	std::map<tN2kAlertUID, uint16_t> Index;
+	std::vector<tN2kAlertJournalRecord> Last(AlertCount);
+	std::vector<bool> Found(AlertCount, false);
+	tN2kAlertJournalRecord Record;
+	uint16_t Restored = 0;
+
+	for (uint16_t i = 0; i < AlertCount; i++) {
+		Index[JournalAlertKey(Alerts[i]->GetAlertUID().Code, Alerts[i]->GetAlertUID().SourceNetworkID)] = i;
+	}
+
+	uint64_t Count = GetRecordCount();
+	for (uint64_t i = 0; i < Count; i++) {
+		if (!ReadRecord(i, Record) || (Record.Type != N2kAlertJournalTransition)) continue;
+		std::map<tN2kAlertUID, uint16_t>::const_iterator it = Index.find(JournalAlertKey(Record.AlertCode, Record.SourceNetworkID));
+		if (it == Index.end()) continue;
+		Last[it->second] = Record;
+		Found[it->second] = true;
+	}
+
+	for (uint16_t i = 0; i < AlertCount; i++) {
+		tN2kAlertSnapshot Snapshot;
+
+		if (!Found[i]) continue;
+		Snapshot.AlertId = Alerts[i]->GetAlertID();
+		Snapshot.Occurence = Last[i].Occurence;
+		Snapshot.State = (Last[i].States >> 4) | (Last[i].Flags & 0xf0);
+		Snapshot.Flags = Last[i].Flags & 0x0f;
+		if (Alerts[i]->RestoreSnapshot(Snapshot)) Restored++;
+	}
+	return Restored;
+}
+
+#endif
@@ -0,0 +1,119 @@
+// N2kAlertJournal.h
+
+#ifndef _N2KALERTJOURNAL_h
+#define _N2KALERTJOURNAL_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include "N2kAlerts.h"
+
+// Append-only journal of alert state changes and 126984 alert responses for
+// Linux based gateways.
+//
+// Records have a fixed size, so record n is at a known file offset and the
+// journal can be searched by time with a binary search (see FindTime()). Record
+// times never go backwards: after the system clock is stepped back, records get
+// the time of the last record until the clock passes it again.
+// Append() only copies the record into a RAM buffer; a writer thread writes
+// the buffer and calls fdatasync() once per group of records, either when
+// GroupSize records are pending or GroupTime ms after the first pending record.
+// A burst of thousands of events per second then costs a few syncs and never
+// blocks the task that receives the CAN messages. A group that fails to write
+// or sync is truncated from the file and counted, see GetErrorCount(). When the
+// disk stalls, at most MaxPending records wait in RAM; further records are
+// dropped and counted.
+//
+// On start Open() drops a torn record at the end of the file and Replay()
+// restores the last state of each alert from the journal.
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <sys/types.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define N2kAlertJournalTransition 1
+#define N2kAlertJournalResponse 2
+
+struct tN2kAlertJournalRecord {
+	uint64_t Time;					// ms since 1970-01-01 UTC
+	uint64_t AlertCode;				// tN2kAlertUID::Code
+	uint64_t SourceNetworkID;		// tN2kAlertUID::SourceNetworkID
+	uint64_t AcknowledgeNetworkID;	// NAME of the responder for responses
+	uint32_t Value;					// Trigger value of a transition, low 32 bits
+	uint8_t Type;					// N2kAlertJournal...
+	uint8_t States;					// Transition: old AlertState bits 0-3, new bits 4-7. Response: command
+	uint8_t Occurence;
+	uint8_t Flags;					// N2kAlertSnapshotFlag... bits 0-3, ThresholdStatus bits 4-7
+	uint32_t Sequence;
+	uint32_t Crc;
+};
+
+class tN2kAlertJournal {
+public:
+	tN2kAlertJournal();
+	~tN2kAlertJournal();
+
+	void SetGroupCommit(size_t _GroupSize, uint32_t _GroupTime);
+	void SetMaxPending(size_t _MaxPending);
+
+	bool Open(const char* FileName);
+	void Close();
+	bool IsOpen() const { return File >= 0; }
+
+	bool Attach(tN2kAlert** Alerts, uint16_t AlertCount);
+
+	void Append(tN2kAlertJournalRecord &Record);
+	void AppendTransition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus);
+	void AppendResponse(const tN2kAlertResponse &AlertResponse);
+	bool HandleMsg(const tN2kMsg &N2kMsg);
+	void Flush();
+
+	// Committed records
+	uint64_t GetRecordCount();
+	bool ReadRecord(uint64_t Index, tN2kAlertJournalRecord &Record);
+	uint64_t FindTime(uint64_t Time);
+
+	// Failed group commits, and the records lost with them or dropped while
+	// MaxPending records were waiting
+	uint32_t GetErrorCount();
+	uint64_t GetLostCount();
+
+	uint16_t Replay(tN2kAlert** Alerts, uint16_t AlertCount);
+
+private:
+	int File;
+	uint32_t Sequence;
+	uint64_t CommittedCount;
+	uint32_t ErrorCount;
+	uint64_t LostCount;
+	size_t GroupSize;
+	uint32_t GroupTime;
+	size_t MaxPending;
+	uint64_t LastTime;
+
+	std::mutex Lock;
+	std::condition_variable Wakeup;
+	std::condition_variable Committed;
+	std::vector<tN2kAlertJournalRecord> Pending;
+	std::vector<tN2kAlertJournalRecord> Writing;
+	bool Stop;
+	bool FlushRequested;
+	std::thread Writer;
+
+	void WriterThread();
+	bool WriteAt(off_t Offset, const void* Data, size_t Size);
+	bool ReadAt(uint64_t Index, tN2kAlertJournalRecord &Record);
+
+	static void OnTransition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus, void* Context);
+};
+
+#endif
+
+#endif
@@ -1,11 +1,130 @@
-// 
-// 
-// 
+//
+//
+//
 
 #include "N2kAlertMessages.h"
 
+//*****************************************************************************
+// Alert key, shared by all alert PGNs
+static void SetN2kAlertKey(tN2kMsg &N2kMsg, const tN2kAlertKey &Key) {
+	unsigned char v;
+
+	v = (Key.AlertCategory << 4) | (Key.AlertType);
+	N2kMsg.AddByte(v);
+	N2kMsg.AddByte(Key.AlertSystem);
+	N2kMsg.AddByte(Key.AlertSubSystem);
+	N2kMsg.Add2ByteUInt(Key.AlertID);
+	N2kMsg.AddUInt64(Key.SourceNetworkID);
+	N2kMsg.AddByte(Key.DataSourceInstance);
+	N2kMsg.AddByte(Key.DataSourceIndex);
+	N2kMsg.AddByte(Key.AlertOccurence);
+}
+
+static void ParseN2kAlertKey(const tN2kMsg &N2kMsg, int &Index, tN2kAlertKey &Key) {
+	unsigned char v;
+
+	v = N2kMsg.GetByte(Index);
+	Key.AlertType = tN2kAlertType(v & 0xf);
+	Key.AlertCategory = tN2kAlertCategory((v >> 4) & 0xf);
+	Key.AlertSystem = N2kMsg.GetByte(Index);
+	Key.AlertSubSystem = N2kMsg.GetByte(Index);
+	Key.AlertID = N2kMsg.Get2ByteUInt(Index);
+	Key.SourceNetworkID = N2kMsg.GetUInt64(Index);
+	Key.DataSourceInstance = N2kMsg.GetByte(Index);
+	Key.DataSourceIndex = N2kMsg.GetByte(Index);
+	Key.AlertOccurence = N2kMsg.GetByte(Index);
+	Key.UID = N2kAlertUID(Key);
+}
+
+static void MakeN2kAlertKey(
+	tN2kAlertKey &Key,
+	tN2kAlertType AlertType,
+	tN2kAlertCategory AlertCategory,
+	unsigned char AlertSystem,
+	unsigned char AlertSubSystem,
+	unsigned int AlertID,
+	uint64_t SourceNetworkID,
+	unsigned char DataSourceInstance,
+	unsigned char DataSourceIndex,
+	unsigned char AlertOccurence
+) {
+	Key.AlertType = AlertType;
+	Key.AlertCategory = AlertCategory;
+	Key.AlertSystem = AlertSystem;
+	Key.AlertSubSystem = AlertSubSystem;
+	Key.AlertID = AlertID;
+	Key.SourceNetworkID = SourceNetworkID;
+	Key.DataSourceInstance = DataSourceInstance;
+	Key.DataSourceIndex = DataSourceIndex;
+	Key.AlertOccurence = AlertOccurence;
+	Key.UID = N2kAlertUID(Key);
+}
+
+static void GetN2kAlertKey(
+	const tN2kAlertKey &Key,
+	tN2kAlertType &AlertType,
+	tN2kAlertCategory &AlertCategory,
+	unsigned char &AlertSystem,
+	unsigned char &AlertSubSystem,
+	unsigned int &AlertID,
+	uint64_t &SourceNetworkID,
+	unsigned char &DataSourceInstance,
+	unsigned char &DataSourceIndex,
+	unsigned char &AlertOccurence
+) {
+	AlertType = Key.AlertType;
+	AlertCategory = Key.AlertCategory;
+	AlertSystem = Key.AlertSystem;
+	AlertSubSystem = Key.AlertSubSystem;
+	AlertID = Key.AlertID;
+	SourceNetworkID = Key.SourceNetworkID;
+	DataSourceInstance = Key.DataSourceInstance;
+	DataSourceIndex = Key.DataSourceIndex;
+	AlertOccurence = Key.AlertOccurence;
+}
+
 //*****************************************************************************
 // This PGN is used to report the status of an aler
+void SetN2kPGN126983(tN2kMsg &N2kMsg, const tN2kAlertNotification &AlertNotification) {
+	unsigned char v;
+
+	N2kMsg.SetPGN(126983L);
+	N2kMsg.Priority = 2;
+	SetN2kAlertKey(N2kMsg, AlertNotification.Key);
+
+	v = (0x03 << 6) | (AlertNotification.EscalationSupport << 5) | (AlertNotification.AcknowledgeSupport << 4) | (AlertNotification.TemporarySilenceSupport << 3) |
+		(AlertNotification.EscalationStatus << 2) | (AlertNotification.AcknowledgeStatus << 1) | AlertNotification.TemporarySilenceStatus;
+	N2kMsg.AddByte(v);
+	N2kMsg.AddUInt64(AlertNotification.AcknowledgeNetworkID);
+
+	v = (AlertNotification.ThresholdStatus << 4) | (AlertNotification.TriggerCondition);
+	N2kMsg.AddByte(v);
+	N2kMsg.AddByte(AlertNotification.AlertPriority);
+	N2kMsg.AddByte(AlertNotification.AlertState);
+}
+
+bool ParseN2kPGN126983(const tN2kMsg &N2kMsg, tN2kAlertNotification &AlertNotification) {
+	if (N2kMsg.PGN != 126983L) return false;
+	int Index = 0;
+	unsigned char v;
+
+	ParseN2kAlertKey(N2kMsg, Index, AlertNotification.Key);
+	v = N2kMsg.GetByte(Index);
+	AlertNotification.TemporarySilenceStatus = tN2kAlertYesNo(v & 0x01);
+	AlertNotification.AcknowledgeStatus = tN2kAlertYesNo((v >> 1) & 0x01);
+	AlertNotification.EscalationStatus = tN2kAlertYesNo((v >> 2) & 0x01);
+	AlertNotification.TemporarySilenceSupport = tN2kAlertYesNo((v >> 3) & 0x01);
+	AlertNotification.AcknowledgeSupport = tN2kAlertYesNo((v >> 4) & 0x01);
+	AlertNotification.EscalationSupport = tN2kAlertYesNo((v >> 5) & 0x01);
+	AlertNotification.AcknowledgeNetworkID = N2kMsg.GetUInt64(Index);
+	v = N2kMsg.GetByte(Index);
+	AlertNotification.TriggerCondition = tN2kAlertTriggerCondition(v & 0xf);
+	AlertNotification.ThresholdStatus = tN2kAlertThresholdStatus((v >> 4) & 0xf);
+	AlertNotification.AlertPriority = N2kMsg.GetByte(Index);
+	AlertNotification.AlertState = tN2kAlertState(N2kMsg.GetByte(Index));
+	return true;
+}
+
 void SetN2kPGN126983(
 	tN2kMsg &N2kMsg,
 	tN2kAlertType AlertType,
@@ -29,28 +148,22 @@ void SetN2kPGN126983(
 	tN2kAlertYesNo AcknowledgeSupport,
 	tN2kAlertYesNo EscalationSupport
 ) {
-	unsigned char v;
-
-	N2kMsg.SetPGN(126983L);
-	N2kMsg.Priority = 2;
-	v = (AlertCategory << 4) | (AlertType);
-	N2kMsg.AddByte(v);
-	N2kMsg.AddByte(AlertSystem);
-	N2kMsg.AddByte(AlertSubSystem);
-	N2kMsg.Add2ByteUInt(AlertID);
-	N2kMsg.AddUInt64(SourceNetworkID);
-	N2kMsg.AddByte(DataSourceInstance);
-	N2kMsg.AddByte(DataSourceIndex);
-	N2kMsg.AddByte(AlertOccurence);
-
-	v = (0x03 << 6) | (EscalationSupport << 5) | (AcknowledgeSupport << 4) | (TemporarySilenceSupport << 3) | (EscalationStatus << 2) | (AcknowledgeStatus << 1) | TemporarySilenceStatus;
-	N2kMsg.AddByte(v);
-	N2kMsg.AddUInt64(AcknowledgeNetworkID);
+	tN2kAlertNotification AlertNotification;
 
-	v = (ThresholdStatus << 4) | (TriggerCondition);
-	N2kMsg.AddByte(v);
-	N2kMsg.AddByte(AlertPriority);
-	N2kMsg.AddByte(AlertState);
+	MakeN2kAlertKey(AlertNotification.Key, AlertType, AlertCategory, AlertSystem, AlertSubSystem, AlertID,
+		SourceNetworkID, DataSourceInstance, DataSourceIndex, AlertOccurence);
+	AlertNotification.AcknowledgeNetworkID = AcknowledgeNetworkID;
+	AlertNotification.TriggerCondition = TriggerCondition;
+	AlertNotification.ThresholdStatus = ThresholdStatus;
+	AlertNotification.AlertPriority = AlertPriority;
+	AlertNotification.AlertState = AlertState;
+	AlertNotification.TemporarySilenceStatus = TemporarySilenceStatus;
+	AlertNotification.AcknowledgeStatus = AcknowledgeStatus;
+	AlertNotification.EscalationStatus = EscalationStatus;
+	AlertNotification.TemporarySilenceSupport = TemporarySilenceSupport;
+	AlertNotification.AcknowledgeSupport = AcknowledgeSupport;
+	AlertNotification.EscalationSupport = EscalationSupport;
+	SetN2kPGN126983(N2kMsg, AlertNotification);
 };
 
 bool ParseN2kPGN126983(
@@ -76,37 +189,46 @@ bool ParseN2kPGN126983(
 	tN2kAlertYesNo &AcknowledgeSupport,
 	tN2kAlertYesNo &EscalationSupport
 ) {
-	if (N2kMsg.PGN != 126983L) return false;
-	int Index = 0;
-	unsigned char v;
-	v = N2kMsg.GetByte(Index);
-	AlertType = tN2kAlertType(v & 0xf);
-	AlertCategory = tN2kAlertCategory((v >> 4) & 0xf);
-	AlertSystem = N2kMsg.GetByte(Index);
-	AlertSubSystem = N2kMsg.GetByte(Index);
-	AlertID = N2kMsg.Get2ByteInt(Index);
-	SourceNetworkID = N2kMsg.GetUInt64(Index);
-	DataSourceInstance = N2kMsg.GetByte(Index);
-	DataSourceIndex = N2kMsg.GetByte(Index);
-	AlertOccurence = N2kMsg.GetByte(Index);
-	v = N2kMsg.GetByte(Index);
-	TemporarySilenceStatus = tN2kAlertYesNo(v & 0x01);
-	AcknowledgeStatus = tN2kAlertYesNo((v >> 1) & 0x01);
-	EscalationStatus = tN2kAlertYesNo((v >> 2) & 0x01);
-	TemporarySilenceSupport = tN2kAlertYesNo((v >> 3) & 0x01);
-	AcknowledgeSupport = tN2kAlertYesNo((v >> 4) & 0x01);
-	EscalationSupport = tN2kAlertYesNo((v >> 5) & 0x01);
-	AcknowledgeNetworkID = N2kMsg.GetUInt64(Index);
-	v = N2kMsg.GetByte(Index);
-	TriggerCondition = tN2kAlertTriggerCondition(v & 0xf);
-	ThresholdStatus = tN2kAlertThresholdStatus((v >> 4) & 0xf);
-	AlertPriority = N2kMsg.GetByte(Index);
-	AlertState = tN2kAlertState(N2kMsg.GetByte(Index));
+	tN2kAlertNotification AlertNotification;
+
+	if (!ParseN2kPGN126983(N2kMsg, AlertNotification)) return false;
+	GetN2kAlertKey(AlertNotification.Key, AlertType, AlertCategory, AlertSystem, AlertSubSystem, AlertID,
+		SourceNetworkID, DataSourceInstance, DataSourceIndex, AlertOccurence);
+	AcknowledgeNetworkID = AlertNotification.AcknowledgeNetworkID;
+	TriggerCondition = AlertNotification.TriggerCondition;
+	ThresholdStatus = AlertNotification.ThresholdStatus;
+	AlertPriority = AlertNotification.AlertPriority;
+	AlertState = AlertNotification.AlertState;
+	TemporarySilenceStatus = AlertNotification.TemporarySilenceStatus;
+	AcknowledgeStatus = AlertNotification.AcknowledgeStatus;
+	EscalationStatus = AlertNotification.EscalationStatus;
+	TemporarySilenceSupport = AlertNotification.TemporarySilenceSupport;
+	AcknowledgeSupport = AlertNotification.AcknowledgeSupport;
+	EscalationSupport = AlertNotification.EscalationSupport;
 	return true;
 }
 
 //*****************************************************************************
 // Alert Response Notification
+void SetN2kPGN126984(tN2kMsg &N2kMsg, const tN2kAlertResponse &AlertResponse) {
+	N2kMsg.SetPGN(126984L);
+	N2kMsg.Priority = 2;
+
+	SetN2kAlertKey(N2kMsg, AlertResponse.Key);
+	N2kMsg.AddUInt64(AlertResponse.AcknowledgeNetworkID);
+	N2kMsg.AddByte(0xFC | AlertResponse.ResponseCommand);
+}
+
+bool ParseN2kPGN126984(const tN2kMsg &N2kMsg, tN2kAlertResponse &AlertResponse) {
+	if (N2kMsg.PGN != 126984L) return false;
+	int Index = 0;
+
+	ParseN2kAlertKey(N2kMsg, Index, AlertResponse.Key);
+	AlertResponse.AcknowledgeNetworkID = N2kMsg.GetUInt64(Index);
+	AlertResponse.ResponseCommand = tN2kAlertResponseCommand(N2kMsg.GetByte(Index) & 0x03);
+	return true;
+}
+
 void SetN2kPGN126984(
 	tN2kMsg &N2kMsg,
 	tN2kAlertType AlertType,
@@ -121,23 +243,13 @@ void SetN2kPGN126984(
 	uint64_t AcknowledgeNetworkID,
 	tN2kAlertResponseCommand ResponseCommand
 ) {
-	unsigned char v;
-	N2kMsg.SetPGN(126984L);
-	N2kMsg.Priority = 2;
+	tN2kAlertResponse AlertResponse;
 
-	v = (AlertCategory << 4) | (AlertType);
-	N2kMsg.AddByte(v);
-	N2kMsg.AddByte(AlertSystem);
-	N2kMsg.AddByte(AlertSubSystem);
-	N2kMsg.Add2ByteUInt(AlertID);
-	N2kMsg.AddUInt64(SourceNetworkID);
-	N2kMsg.AddByte(DataSourceInstance);
-	N2kMsg.AddByte(DataSourceIndex);
-	N2kMsg.AddByte(AlertOccurence);
-	N2kMsg.AddUInt64(AcknowledgeNetworkID);
-
-	v = 0xFC | ResponseCommand;
-	N2kMsg.AddByte(v);
+	MakeN2kAlertKey(AlertResponse.Key, AlertType, AlertCategory, AlertSystem, AlertSubSystem, AlertID,
+		SourceNetworkID, DataSourceInstance, DataSourceIndex, AlertOccurence);
+	AlertResponse.AcknowledgeNetworkID = AcknowledgeNetworkID;
+	AlertResponse.ResponseCommand = ResponseCommand;
+	SetN2kPGN126984(N2kMsg, AlertResponse);
 }
 
 bool ParseN2kPGN126984(
@@ -154,27 +266,44 @@ bool ParseN2kPGN126984(
 	uint64_t &AcknowledgeNetworkID,
 	tN2kAlertResponseCommand &ResponseCommand
 ) {
-	if (N2kMsg.PGN != 126984L) return false;
-	int Index = 0;
-	unsigned char v;
-	v = N2kMsg.GetByte(Index);
-	AlertType = tN2kAlertType(v & 0xf);
-	AlertCategory = tN2kAlertCategory((v >> 4) & 0xf);
-	AlertSystem = N2kMsg.GetByte(Index);
-	AlertSubSystem = N2kMsg.GetByte(Index);
-	AlertID = N2kMsg.Get2ByteInt(Index);
-	SourceNetworkID = N2kMsg.GetUInt64(Index);
-	DataSourceInstance = N2kMsg.GetByte(Index);
-	DataSourceIndex = N2kMsg.GetByte(Index);
-	AlertOccurence = N2kMsg.GetByte(Index);
-	AcknowledgeNetworkID = N2kMsg.GetUInt64(Index);
-	v = N2kMsg.GetByte(Index);
-	ResponseCommand = tN2kAlertResponseCommand(v & 0x03);
+	tN2kAlertResponse AlertResponse;
+
+	if (!ParseN2kPGN126984(N2kMsg, AlertResponse)) return false;
+	GetN2kAlertKey(AlertResponse.Key, AlertType, AlertCategory, AlertSystem, AlertSubSystem, AlertID,
+		SourceNetworkID, DataSourceInstance, DataSourceIndex, AlertOccurence);
+	AcknowledgeNetworkID = AlertResponse.AcknowledgeNetworkID;
+	ResponseCommand = AlertResponse.ResponseCommand;
 	return true;
 }
 
 //*****************************************************************************
 // Alert Text Notification
+void SetN2kPGN126985(tN2kMsg &N2kMsg, const tN2kAlertText &AlertText) {
+	N2kMsg.SetPGN(126985L);
+	N2kMsg.Priority = 2;
+
+	SetN2kAlertKey(N2kMsg, AlertText.Key);
+	N2kMsg.AddByte(AlertText.AlertLanguage);
+	N2kMsg.AddVarStr(AlertText.AlertTextDescription);
+	N2kMsg.AddVarStr(AlertText.AlertLocationTextDescription);
+}
+
+bool ParseN2kPGN126985(const tN2kMsg &N2kMsg, tN2kAlertText &AlertText) {
+	if (N2kMsg.PGN != 126985L) return false;
+	int Index = 0;
+	size_t StrSize;
+
+	ParseN2kAlertKey(N2kMsg, Index, AlertText.Key);
+	AlertText.AlertLanguage = tN2kAlertLanguage(N2kMsg.GetByte(Index));
+	StrSize = sizeof(AlertText.AlertTextDescription);
+	N2kMsg.GetVarStr(StrSize, AlertText.AlertTextDescription, Index);
+	StrSize = sizeof(AlertText.AlertLocationTextDescription);
+	N2kMsg.GetVarStr(StrSize, AlertText.AlertLocationTextDescription, Index);
+	return true;
+}
+
+// The text is added directly from the caller's strings, so no record is
+// built here and the strings are not copied.
 void SetN2kPGN126985(
 	tN2kMsg &N2kMsg,
 	tN2kAlertType AlertType,
@@ -187,23 +316,16 @@ void SetN2kPGN126985(
 	unsigned char DataSourceIndex,
 	unsigned char AlertOccurence,
 	tN2kAlertLanguage AlertLanguage,
-	char* AlertTextDescription,
-	char* AlertLocationTextDescription
+	const char* AlertTextDescription,
+	const char* AlertLocationTextDescription
 ) {
-	unsigned char v;
+	tN2kAlertKey Key;
 
+	MakeN2kAlertKey(Key, AlertType, AlertCategory, AlertSystem, AlertSubSystem, AlertID,
+		SourceNetworkID, DataSourceInstance, DataSourceIndex, AlertOccurence);
 	N2kMsg.SetPGN(126985L);
 	N2kMsg.Priority = 2;
-
-	v = (AlertCategory << 4) | (AlertType);
-	N2kMsg.AddByte(v);
-	N2kMsg.AddByte(AlertSystem);
-	N2kMsg.AddByte(AlertSubSystem);
-	N2kMsg.Add2ByteUInt(AlertID);
-	N2kMsg.AddUInt64(SourceNetworkID);
-	N2kMsg.AddByte(DataSourceInstance);
-	N2kMsg.AddByte(DataSourceIndex);
-	N2kMsg.AddByte(AlertOccurence);
+	SetN2kAlertKey(N2kMsg, Key);
 	N2kMsg.AddByte(AlertLanguage);
 	N2kMsg.AddVarStr(AlertTextDescription);
 	N2kMsg.AddVarStr(AlertLocationTextDescription);
@@ -224,25 +346,14 @@ bool ParseN2kPGN126985(
 	char* &AlertTextDescription,
 	char* &AlertLocationTextDescription
 ) {
-	if (N2kMsg.PGN != 126985L) return false;
-	int Index = 0;
-	unsigned char v;
-	v = N2kMsg.GetByte(Index);
-	AlertType = tN2kAlertType(v & 0xf);
-	AlertCategory = tN2kAlertCategory((v >> 4) & 0xf);
-	AlertSystem = N2kMsg.GetByte(Index);
-	AlertSubSystem = N2kMsg.GetByte(Index);
-	AlertID = N2kMsg.Get2ByteInt(Index);
-	SourceNetworkID = N2kMsg.GetUInt64(Index);
-	DataSourceInstance = N2kMsg.GetByte(Index);
-	DataSourceIndex = N2kMsg.GetByte(Index);
-	AlertOccurence = N2kMsg.GetByte(Index);
-	AlertLanguage = tN2kAlertLanguage(N2kMsg.GetByte(Index));
-	size_t AlertTextDescriptionSize = sizeof(AlertTextDescription);
-	N2kMsg.GetVarStr(AlertTextDescriptionSize, (char*)AlertTextDescription, Index);
-	size_t AlertLocationTextDescriptionSize = sizeof(AlertLocationTextDescription);
-	N2kMsg.GetVarStr(AlertLocationTextDescriptionSize, (char*)AlertLocationTextDescription, Index);
+	tN2kAlertText AlertText;
+
+	if (!ParseN2kPGN126985(N2kMsg, AlertText)) return false;
+	GetN2kAlertKey(AlertText.Key, AlertType, AlertCategory, AlertSystem, AlertSubSystem, AlertID,
+		SourceNetworkID, DataSourceInstance, DataSourceIndex, AlertOccurence);
+	AlertLanguage = AlertText.AlertLanguage;
+	strcpy(AlertTextDescription, AlertText.AlertTextDescription);
+	strcpy(AlertLocationTextDescription, AlertText.AlertLocationTextDescription);
 	return true;
 };
 
-
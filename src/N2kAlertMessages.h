@@ -12,9 +12,121 @@
 #include <N2kMessages.h>
 #include "N2kAlertTypes.h"
 
+#ifndef N2kAlertTextLen
+#define N2kAlertTextLen 50
+#endif
+
+//*****************************************************************************
+// Alert records
+//
+// The records below hold the decoded content of the alert PGNs, so a message
+// can be built, parsed, stored and compared as one unit and passed by
+// reference instead of as 20 separate arguments.
+
+// Compact alert identity. AlertType, AlertCategory, AlertSystem, AlertSubSystem
+// and AlertID are packed into Code, so two alerts are the same alert when Code
+// and SourceNetworkID (the NAME of the data source) are equal. The key can be
+// used directly in hash tables and sorted indexes.
+struct tN2kAlertUID {
+    uint64_t Code;
+    uint64_t SourceNetworkID;
+
+    bool operator==(const tN2kAlertUID &Other) const {
+        return (Code == Other.Code) && (SourceNetworkID == Other.SourceNetworkID);
+    }
+    bool operator!=(const tN2kAlertUID &Other) const {
+        return !(*this == Other);
+    }
+    bool operator<(const tN2kAlertUID &Other) const {
+        return (Code < Other.Code) || ((Code == Other.Code) && (SourceNetworkID < Other.SourceNetworkID));
+    }
+    uint32_t Hash() const {
+        uint64_t h = Code ^ (SourceNetworkID * 0x9E3779B97F4A7C15ULL);
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        return (uint32_t)h;
+    }
+};
+
+inline uint64_t N2kAlertCode(tN2kAlertType AlertType, tN2kAlertCategory AlertCategory, unsigned char AlertSystem,
+    unsigned char AlertSubSystem, unsigned int AlertID) {
+    return ((uint64_t)(AlertCategory & 0xf) << 36) | ((uint64_t)(AlertType & 0xf) << 32) |
+        ((uint64_t)AlertSystem << 24) | ((uint64_t)AlertSubSystem << 16) | (AlertID & 0xffff);
+}
+
+inline tN2kAlertUID N2kAlertUID(tN2kAlertType AlertType, tN2kAlertCategory AlertCategory, unsigned char AlertSystem,
+    unsigned char AlertSubSystem, unsigned int AlertID, uint64_t SourceNetworkID) {
+    tN2kAlertUID UID;
+    UID.Code = N2kAlertCode(AlertType, AlertCategory, AlertSystem, AlertSubSystem, AlertID);
+    UID.SourceNetworkID = SourceNetworkID;
+    return UID;
+}
+
+// Fields common to PGN 126983, 126984 and 126985. UID is filled in when a
+// message is parsed and is ignored when a message is built.
+struct tN2kAlertKey {
+    tN2kAlertType AlertType;
+    tN2kAlertCategory AlertCategory;
+    unsigned char AlertSystem;
+    unsigned char AlertSubSystem;
+    unsigned int AlertID;
+    uint64_t SourceNetworkID;
+    unsigned char DataSourceInstance;
+    unsigned char DataSourceIndex;
+    unsigned char AlertOccurence;
+    tN2kAlertUID UID;
+};
+
+inline tN2kAlertUID N2kAlertUID(const tN2kAlertKey &Key) {
+    return N2kAlertUID(Key.AlertType, Key.AlertCategory, Key.AlertSystem, Key.AlertSubSystem, Key.AlertID, Key.SourceNetworkID);
+}
+
+// PGN 126983
+struct tN2kAlertNotification {
+    tN2kAlertKey Key;
+    uint64_t AcknowledgeNetworkID;
+    tN2kAlertTriggerCondition TriggerCondition;
+    tN2kAlertThresholdStatus ThresholdStatus;
+    unsigned char AlertPriority;
+    tN2kAlertState AlertState;
+    tN2kAlertYesNo TemporarySilenceStatus;
+    tN2kAlertYesNo AcknowledgeStatus;
+    tN2kAlertYesNo EscalationStatus;
+    tN2kAlertYesNo TemporarySilenceSupport;
+    tN2kAlertYesNo AcknowledgeSupport;
+    tN2kAlertYesNo EscalationSupport;
+};
+
+// PGN 126984
+struct tN2kAlertResponse {
+    tN2kAlertKey Key;
+    uint64_t AcknowledgeNetworkID;
+    tN2kAlertResponseCommand ResponseCommand;
+};
+
+// PGN 126985
+struct tN2kAlertText {
+    tN2kAlertKey Key;
+    tN2kAlertLanguage AlertLanguage;
+    char AlertTextDescription[N2kAlertTextLen + 1];
+    char AlertLocationTextDescription[N2kAlertTextLen + 1];
+};
+
 //*****************************************************************************
 // Alert Notification
 
+extern void SetN2kPGN126983(tN2kMsg &N2kMsg, const tN2kAlertNotification &AlertNotification);
+extern bool ParseN2kPGN126983(const tN2kMsg &N2kMsg, tN2kAlertNotification &AlertNotification);
+
+inline void SetN2kAlert(tN2kMsg &N2kMsg, const tN2kAlertNotification &AlertNotification) {
+    SetN2kPGN126983(N2kMsg, AlertNotification);
+}
+
+inline bool ParseN2kAlert(const tN2kMsg &N2kMsg, tN2kAlertNotification &AlertNotification) {
+    return ParseN2kPGN126983(N2kMsg, AlertNotification);
+}
+
 extern void SetN2kPGN126983(
     tN2kMsg &N2kMsg,
     tN2kAlertType AlertType,
@@ -95,6 +207,17 @@ extern bool ParseN2kPGN126983(
 //*****************************************************************************
 // Alert Response Notification
 
+extern void SetN2kPGN126984(tN2kMsg &N2kMsg, const tN2kAlertResponse &AlertResponse);
+extern bool ParseN2kPGN126984(const tN2kMsg &N2kMsg, tN2kAlertResponse &AlertResponse);
+
+inline void SetN2kAlertReponse(tN2kMsg &N2kMsg, const tN2kAlertResponse &AlertResponse) {
+    SetN2kPGN126984(N2kMsg, AlertResponse);
+}
+
+inline bool ParseN2kAlertResponse(const tN2kMsg &N2kMsg, tN2kAlertResponse &AlertResponse) {
+    return ParseN2kPGN126984(N2kMsg, AlertResponse);
+}
+
 extern void SetN2kPGN126984(
     tN2kMsg &N2kMsg,
     tN2kAlertType AlertType,
@@ -158,7 +281,7 @@ inline bool ParseN2kAlertResponse(
     uint64_t &AcknowledgeNetworkID,
     tN2kAlertResponseCommand &ResponseCommand
 ) {
-    ParseN2kPGN126984(N2kMsg, AlertType, AlertCategory, AlertSystem, AlertSubSystem, AlertID, 
+    return ParseN2kPGN126984(N2kMsg, AlertType, AlertCategory, AlertSystem, AlertSubSystem, AlertID, 
         SourceNetworkID, DataSourceInstance, DataSourceIndex, AlertOccurence, AcknowledgeNetworkID, 
         ResponseCommand);
 };
@@ -166,6 +289,17 @@ inline bool ParseN2kAlertResponse(
 //*****************************************************************************
 // Alert Text Notification
 
+extern void SetN2kPGN126985(tN2kMsg &N2kMsg, const tN2kAlertText &AlertText);
+extern bool ParseN2kPGN126985(const tN2kMsg &N2kMsg, tN2kAlertText &AlertText);
+
+inline void SetN2kAlertText(tN2kMsg &N2kMsg, const tN2kAlertText &AlertText) {
+    SetN2kPGN126985(N2kMsg, AlertText);
+}
+
+inline bool ParseN2kAlertText(const tN2kMsg &N2kMsg, tN2kAlertText &AlertText) {
+    return ParseN2kPGN126985(N2kMsg, AlertText);
+}
+
 extern void SetN2kPGN126985(
     tN2kMsg &N2kMsg,
     tN2kAlertType AlertType,
@@ -178,8 +312,8 @@ extern void SetN2kPGN126985(
     unsigned char DataSourceIndex,
     unsigned char AlertOccurence,
     tN2kAlertLanguage AlertLanguage,
-    char* AlertTextDescription,
-    char* AlertLocationTextDescription
+    const char* AlertTextDescription,
+    const char* AlertLocationTextDescription
 );
 
 inline void SetN2kAlertText(
@@ -194,8 +328,8 @@ inline void SetN2kAlertText(
     unsigned char DataSourceIndex,
     unsigned char AlertOccurence,
     tN2kAlertLanguage AlertLanguage,
-    char* AlertTextDescription,
-    char* AlertLocationTextDescription
+    const char* AlertTextDescription,
+    const char* AlertLocationTextDescription
 ) {
     SetN2kPGN126985(N2kMsg, AlertType, AlertCategory, AlertSystem, AlertSubSystem, AlertID,
         SourceNetworkID, DataSourceInstance, DataSourceIndex, AlertOccurence, AlertLanguage,
@@ -215,6 +349,7 @@ extern bool ParseN2kPGN126985(
     unsigned char &DataSourceIndex,
     unsigned char &AlertOccurence,
     tN2kAlertLanguage &AlertLanguage,
+    // Both text buffers must hold at least N2kAlertTextLen + 1 characters
     char* &AlertTextDescription,
     char* &AlertLocationTextDescription
 );
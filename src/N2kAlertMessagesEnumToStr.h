@@ -14,7 +14,19 @@
 /************************************************************************//**
  * \brief Default value if no string representation is found
  */
-const char* N2kEnumTypeEmpty = "";
+constexpr const char* N2kEnumAlertTypeEmpty = "";
+
+/************************************************************************//**
+ * \brief Hash used for the string to enum lookup (32 bit FNV-1a)
+ *
+ * The function is constexpr, so the hash of every enum string is known at
+ * compile time and used as a case label. Two strings of one enum with the
+ * same hash would give duplicate case labels, so the lookup is a perfect
+ * hash checked by the compiler.
+ */
+constexpr uint32_t N2kEnumAlertStrHash(const char* str, uint32_t hash = 2166136261UL) {
+    return (*str == '\0') ? hash : N2kEnumAlertStrHash(str + 1, (uint32_t)((hash ^ (uint8_t)*str) * 16777619UL));
+}
 
 /************************************************************************//**
  * \brief Print function for the enum values
@@ -29,7 +41,7 @@ const char* N2kEnumTypeEmpty = "";
  * @param addLF         add a line feed (default = true)
  */
 template<typename T> void PrintN2kEnumAlertType(T a, Stream* OutputStream, bool addLF = true) {
-    const char* str = N2kEnumTypeToStr(a);
+    const char* str = N2kEnumAlertTypeToStr(a);
     if (str[0] != '\0') {
         if (addLF) { OutputStream->println(str); }
         else { OutputStream->print(str); }
@@ -38,118 +50,183 @@ template<typename T> void PrintN2kEnumAlertType(T a, Stream* OutputStream, bool
         OutputStream->print(F("unknown (")); OutputStream->print(a); OutputStream->println(F(")"));
     }
 }
+
+#define N2kEnumAlertStrCase(enumVal, str) case enumVal: return str;
+#define N2kEnumAlertHashCase(enumVal, str) case N2kEnumAlertStrHash(str): \
+    if (strcmp(Str, str) != 0) return false; \
+    EnumVal = enumVal; return true;
+
 /************************************************************************//**
  * \brief Macro function for converting various N2k Enums to a const char
+ *        and back
  *
  * This generic macro defines a way to use a specific version of
- * **N2kEnumTypeToStr(enumType enumVal)** depending on which enumType is
- * given as parameter.
+ * **N2kEnumAlertTypeToStr(enumType enumVal)** and
+ * **N2kStrToEnumAlertType(const char* Str, enumType &EnumVal)** depending on
+ * which enumType is given as parameter.
  *
- * In NMEA2000 messages there are several enumerations defined and used
- * for the states of different systems. E.g tN2kBatType holds all the
- * available battery types like "flooded", "gel", "AGM". If you need
- * the "real" values of these enums written to a string
- * (e.g. for debugging), you can use these functions.
+ * The strings are given as a descriptor macro listing each enum value with
+ * its text. The lookup is a switch over the enum values, so sparse enums like
+ * tN2kAlertType map correctly. All functions are inline and the strings are
+ * literals, so the header can be included in any number of translation units
+ * and the texts are placed in read only memory (flash on ESP32 and ARM).
  *
  *
- * ### Usage of the function N2kEnumTypeToStr(enumType enumVal):
+ * ### Usage of the functions:
  *
  * ```
- * tN2kBatType batCem = N2kDCbt_Gel;
- * const char* tmp;
- * tmp = N2kEnumTypeToStr(batCem);
+ * tN2kAlertType AlertType = N2kts_AlertTypeWarning;
+ * Serial.print(N2kEnumAlertTypeToStr(AlertType));  // Output to serial =>  warning
  *
- * Serial.print(tmp);     // Output to serial =>  Gel
+ * if (N2kStrToEnumAlertType("caution", AlertType)) { ... }
  * ```
  *
  */
-#define MakeN2kEnumAlertTypeToStrFunc(enumType,strs) \
-const char * N2kEnumAlertTypeToStr(enumType enumVal) { \
-  if ( enumVal<(sizeof(strs)/sizeof(const char *)) ) { \
-    return strs[enumVal]; \
-  } else { return N2kEnumTypeEmpty; }\
+#define MakeN2kEnumAlertTypeToStrFunc(enumType,enumStrs) \
+inline const char * N2kEnumAlertTypeToStr(enumType enumVal) { \
+  switch (enumVal) { \
+    enumStrs(N2kEnumAlertStrCase) \
+    default: break; \
+  } \
+  return N2kEnumAlertTypeEmpty; \
+} \
+inline bool N2kStrToEnumAlertType(const char* Str, enumType &EnumVal) { \
+  switch (N2kEnumAlertStrHash(Str)) { \
+    enumStrs(N2kEnumAlertHashCase) \
+    default: break; \
+  } \
+  return false; \
 }
 
- /************************************************************************//**
-  * \brief string representation of the N2k enum tN2kAlertType
-  */
-const char* tN2kAlertTypeStrs[] = { "emergency alarm", "alarm", "warning", "caution"};
+/************************************************************************//**
+ * \brief string representation of the N2k enum tN2kAlertType
+ */
+#define tN2kAlertTypeStrs(X) \
+    X(N2kts_AlertTypeEmergencyAlarm, "emergency alarm") \
+    X(N2kts_AlertTypeAlarm, "alarm") \
+    X(N2kts_AlertTypeWarning, "warning") \
+    X(N2kts_AlertTypeCaution, "caution")
 /************************************************************************//**
  * \brief Converting the N2k enum \ref tN2kAlertType to a const char
  */
-MakeN2kEnumAlertTypeToStrFunc(tN2kAlertType, tN2kAlertTypeStrs);
+MakeN2kEnumAlertTypeToStrFunc(tN2kAlertType, tN2kAlertTypeStrs)
 
 /************************************************************************//**
  * \brief string representation of the N2k enum tN2kAlertCategory
  */
-const char* tN2kAlertCategoryStrs[] = { "navigational", "technical" };
+#define tN2kAlertCategoryStrs(X) \
+    X(N2kts_AlertCategoryNavigational, "navigational") \
+    X(N2kts_AlertCategoryTechnical, "technical")
 /************************************************************************//**
  * \brief Converting the N2k enum \ref tN2kAlertCategory to a const char
  */
-MakeN2kEnumAlertTypeToStrFunc(tN2kAlertCategory, tN2kAlertCategoryStrs);
+MakeN2kEnumAlertTypeToStrFunc(tN2kAlertCategory, tN2kAlertCategoryStrs)
 
 /************************************************************************//**
  * \brief string representation of the N2k enum tN2kAlertTriggerCondition
  */
-const char* tN2kAlertTriggerConditionStrs[] = { "manual", "auto", "test", "disabled"};
+#define tN2kAlertTriggerConditionStrs(X) \
+    X(N2kts_AlertTriggerManual, "manual") \
+    X(N2kts_AlertTriggerAuto, "auto") \
+    X(N2kts_AlertTriggerTest, "test") \
+    X(N2kts_AlertTriggerDisabled, "disabled")
 /************************************************************************//**
  * \brief Converting the N2k enum \ref tN2kAlertTriggerCondition to a const char
  */
-MakeN2kEnumAlertTypeToStrFunc(tN2kAlertTriggerCondition, tN2kAlertTriggerConditionStrs);
+MakeN2kEnumAlertTypeToStrFunc(tN2kAlertTriggerCondition, tN2kAlertTriggerConditionStrs)
 
 /************************************************************************//**
  * \brief string representation of the N2k enum tN2kAlertThresholdStatus
  */
-const char* tN2kAlertThresholdStatusStrs[] = { "normal", "exceeded", "extreme exceeded", "low exceeded", "acknowledged", "awaiting acknowledge"};
+#define tN2kAlertThresholdStatusStrs(X) \
+    X(N2kts_AlertThresholdStatusNormal, "normal") \
+    X(N2kts_AlertThresholdStatusExceeded, "exceeded") \
+    X(N2kts_AlertThresholdStatusExtremeExceeded, "extreme exceeded") \
+    X(N2kts_AlertThresholdStatusLowExceeded, "low exceeded") \
+    X(N2kts_AlertThresholdStatusAcknowledged, "acknowledged") \
+    X(N2kts_AlertThresholdStatusAwaitingAcknowledge, "awaiting acknowledge")
 /************************************************************************//**
  * \brief Converting the N2k enum \ref tN2kAlertThresholdStatus to a const char
  */
-MakeN2kEnumAlertTypeToStrFunc(tN2kAlertThresholdStatus, tN2kAlertThresholdStatusStrs);
+MakeN2kEnumAlertTypeToStrFunc(tN2kAlertThresholdStatus, tN2kAlertThresholdStatusStrs)
 
 /************************************************************************//**
  * \brief string representation of the N2k enum tN2kAlertState
  */
-const char* tN2kAlertStateStrs[] = { "disable", "normal", "active", "silenced", "acknowledged", "awaiting acknowledge" };
+#define tN2kAlertStateStrs(X) \
+    X(N2kts_AlertStateDisabled, "disable") \
+    X(N2kts_AlertStateNormal, "normal") \
+    X(N2kts_AlertStateActive, "active") \
+    X(N2kts_AlertStateSilenced, "silenced") \
+    X(N2kts_AlertStateAcknowledged, "acknowledged") \
+    X(N2kts_AlertStateAwaitingAcknowledge, "awaiting acknowledge")
 /************************************************************************//**
  * \brief Converting the N2k enum \ref tN2kAlertState to a const char
  */
-MakeN2kEnumAlertTypeToStrFunc(tN2kAlertState, tN2kAlertStateStrs);
+MakeN2kEnumAlertTypeToStrFunc(tN2kAlertState, tN2kAlertStateStrs)
 
 /************************************************************************//**
  * \brief string representation of the N2k enum tN2kAlertLanguage
  */
-const char* tN2kAlertLanguageStrs[] = { "English US", "English UK", "Arabic", "Chinese simplified", "Croatian", "Danish", "Dutch", "Finnish", 
-                                        "French", "German", "Greek", "Italian", "Japanese", "Korean", "Norwegian", "Polish", "Portuguese", 
-                                        "Russian", "Spanish", "Swedish"};
+#define tN2kAlertLanguageStrs(X) \
+    X(N2kts_AlertLanguageEnglishUS, "English US") \
+    X(N2kts_AlertLanguageEnglishUK, "English UK") \
+    X(N2kts_AlertLanguageArabic, "Arabic") \
+    X(N2kts_AlertLanguageChineseSimplified, "Chinese simplified") \
+    X(N2kts_AlertLanguageCroatian, "Croatian") \
+    X(N2kts_AlertLanguageDanish, "Danish") \
+    X(N2kts_AlertLanguageDutch, "Dutch") \
+    X(N2kts_AlertLanguageFinnish, "Finnish") \
+    X(N2kts_AlertLanguageFrench, "French") \
+    X(N2kts_AlertLanguageGerman, "German") \
+    X(N2kts_AlertLanguageGreek, "Greek") \
+    X(N2kts_AlertLanguageItalian, "Italian") \
+    X(N2kts_AlertLanguageJapanese, "Japanese") \
+    X(N2kts_AlertLanguageKorean, "Korean") \
+    X(N2kts_AlertLanguageNorwegian, "Norwegian") \
+    X(N2kts_AlertLanguagePolish, "Polish") \
+    X(N2kts_AlertLanguagePortuguese, "Portuguese") \
+    X(N2kts_AlertLanguageRussian, "Russian") \
+    X(N2kts_AlertLanguageSpanish, "Spanish") \
+    X(N2kts_AlertLanguageSwedish, "Swedish")
 /************************************************************************//**
  * \brief Converting the N2k enum \ref tN2kAlertLanguage to a const char
  */
-MakeN2kEnumAlertTypeToStrFunc(tN2kAlertLanguage, tN2kAlertLanguageStrs);
+MakeN2kEnumAlertTypeToStrFunc(tN2kAlertLanguage, tN2kAlertLanguageStrs)
 
 /************************************************************************//**
  * \brief string representation of the N2k enum tN2kAlertResponseCommand
  */
-const char* tN2kAlertResponseCommandStrs[] = { "acknowledge", "temporary silence", "test command off", "test command on"};
+#define tN2kAlertResponseCommandStrs(X) \
+    X(N2kts_AlertResponseAcknowledge, "acknowledge") \
+    X(N2kts_AlertResponseTemporarySilence, "temporary silence") \
+    X(N2kts_AlertResponseTestCommandOff, "test command off") \
+    X(N2kts_AlertResponseTestCommandOn, "test command on")
 /************************************************************************//**
  * \brief Converting the N2k enum \ref tN2kAlertResponseCommand to a const char
  */
-MakeN2kEnumAlertTypeToStrFunc(tN2kAlertResponseCommand, tN2kAlertResponseCommandStrs);
+MakeN2kEnumAlertTypeToStrFunc(tN2kAlertResponseCommand, tN2kAlertResponseCommandStrs)
 
 /************************************************************************//**
  * \brief string representation of the N2k enum tN2kAlertYesNo
  */
-const char* tN2kAlertYesNoStrs[] = { "no", "yes" };
+#define tN2kAlertYesNoStrs(X) \
+    X(N2kts_AlertNo, "no") \
+    X(N2kts_AlertYes, "yes")
 /************************************************************************//**
  * \brief Converting the N2k enum \ref tN2kAlertYesNo to a const char
  */
-MakeN2kEnumAlertTypeToStrFunc(tN2kAlertYesNo, tN2kAlertYesNoStrs);
+MakeN2kEnumAlertTypeToStrFunc(tN2kAlertYesNo, tN2kAlertYesNoStrs)
 
 /************************************************************************//**
  * \brief string representation of the N2k enum t2kNAlertThresholdMethod
  */
-const char* t2kNAlertThresholdMethodStrs[] = { "equal", "lower then", "greater then" };
+#define t2kNAlertThresholdMethodStrs(X) \
+    X(N2kts_AlertThresholdMethodEqual, "equal") \
+    X(N2kts_AlertThresholdMethodLower, "lower then") \
+    X(N2kts_AlertThresholddMethodGreater, "greater then")
 /************************************************************************//**
  * \brief Converting the N2k enum \ref t2kNAlertThresholdMethod to a const char
  */
-MakeN2kEnumAlertTypeToStrFunc(t2kNAlertThresholdMethod, t2kNAlertThresholdMethodStrs);
+MakeN2kEnumAlertTypeToStrFunc(t2kNAlertThresholdMethod, t2kNAlertThresholdMethodStrs)
 #endif
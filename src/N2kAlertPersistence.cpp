@@ -0,0 +1,174 @@
+//
+//
+//
+
+#include "N2kAlertPersistence.h"
+
+#define N2kAlertPersistenceMagic 0xA1E7
+#define N2kAlertPersistenceVersion 1
+#define N2kAlertPersistenceHeaderSize 7
+
+static void PackSnapshot(const tN2kAlertSnapshot &Snapshot, uint8_t* Data) {
+	Data[0] = Snapshot.AlertId & 0xff;
+	Data[1] = Snapshot.AlertId >> 8;
+	Data[2] = Snapshot.Occurence;
+	Data[3] = Snapshot.State;
+	Data[4] = Snapshot.Flags;
+}
+
+static void UnpackSnapshot(const uint8_t* Data, tN2kAlertSnapshot &Snapshot) {
+	Snapshot.AlertId = Data[0] | (Data[1] << 8);
+	Snapshot.Occurence = Data[2];
+	Snapshot.State = Data[3];
+	Snapshot.Flags = Data[4];
+}
+
+// Fletcher-16
+static void AddChecksum(uint16_t &Sum1, uint16_t &Sum2, const uint8_t* Data, size_t Size) {
+	for (size_t i = 0; i < Size; i++) {
+		Sum1 = (Sum1 + Data[i]) % 255;
+		Sum2 = (Sum2 + Sum1) % 255;
+	}
+}
+
+tN2kAlertPersistence::tN2kAlertPersistence(tN2kAlertStorage &_Storage, tN2kAlert** _Alerts, uint16_t _AlertCount, size_t _Address) :
+	Storage(_Storage),
+	Alerts(_Alerts),
+	AlertCount(_AlertCount),
+	Address(_Address),
+	WriteInterval(10000),
+	SavedHash(0) {
+
+	WriteTimer.FromNow(WriteInterval);
+}
+
+// Minimum time between two writes. Changes made within the interval are
+// written together.
+void tN2kAlertPersistence::SetWriteInterval(uint32_t ms) {
+	WriteInterval = ms;
+	WriteTimer.FromNow(WriteInterval);
+}
+
+size_t tN2kAlertPersistence::GetStorageSize() const {
+	return N2kAlertPersistenceHeaderSize + (size_t)AlertCount * N2kAlertSnapshotSize;
+}
+
+// Checksum of the records as stored, plus a 32 bit FNV-1a hash that is kept in
+// RAM to detect changes without reading the storage back.
+void tN2kAlertPersistence::Checksum(uint16_t &_Checksum, uint32_t &Hash) {
+	uint16_t Sum1 = 0;
+	uint16_t Sum2 = 0;
+	tN2kAlertSnapshot Snapshot;
+	uint8_t Data[N2kAlertSnapshotSize];
+
+	Hash = 2166136261UL;
+	for (uint16_t i = 0; i < AlertCount; i++) {
+		Alerts[i]->GetSnapshot(Snapshot);
+		PackSnapshot(Snapshot, Data);
+		AddChecksum(Sum1, Sum2, Data, N2kAlertSnapshotSize);
+		for (uint8_t j = 0; j < N2kAlertSnapshotSize; j++) {
+			Hash = (Hash ^ Data[j]) * 16777619UL;
+		}
+	}
+	_Checksum = (Sum2 << 8) | Sum1;
+}
+
+bool tN2kAlertPersistence::ReadRecord(uint16_t Index, tN2kAlertSnapshot &Snapshot) {
+	uint8_t Data[N2kAlertSnapshotSize];
+
+	if (!Storage.Read(Address + N2kAlertPersistenceHeaderSize + (size_t)Index * N2kAlertSnapshotSize, Data, N2kAlertSnapshotSize)) return false;
+	UnpackSnapshot(Data, Snapshot);
+	return true;
+}
+
+bool tN2kAlertPersistence::WriteRecord(uint16_t Index, const tN2kAlertSnapshot &Snapshot) {
+	uint8_t Data[N2kAlertSnapshotSize];
+
+	PackSnapshot(Snapshot, Data);
+	return Storage.Write(Address + N2kAlertPersistenceHeaderSize + (size_t)Index * N2kAlertSnapshotSize, Data, N2kAlertSnapshotSize);
+}
+
+bool tN2kAlertPersistence::WriteHeader(uint16_t _Checksum) {
+	uint8_t Header[N2kAlertPersistenceHeaderSize];
+
+	Header[0] = N2kAlertPersistenceMagic & 0xff;
+	Header[1] = N2kAlertPersistenceMagic >> 8;
+	Header[2] = N2kAlertPersistenceVersion;
+	Header[3] = AlertCount & 0xff;
+	Header[4] = AlertCount >> 8;
+	Header[5] = _Checksum & 0xff;
+	Header[6] = _Checksum >> 8;
+	return Storage.Write(Address, Header, N2kAlertPersistenceHeaderSize);
+}
+
+// Restores all alerts from the storage. The records are read once into a
+// temporary buffer, and the snapshot is only used when the header and checksum
+// are valid, so a write interrupted by a reset leaves all alerts in their
+// initial state. An alert whose AlertId does not match its record, e.g. after
+// the alert list was changed, keeps its initial state.
+bool tN2kAlertPersistence::Restore() {
+	uint8_t Header[N2kAlertPersistenceHeaderSize];
+	uint8_t* Data;
+	uint16_t Count;
+	uint16_t _Checksum;
+	uint16_t Sum1 = 0;
+	uint16_t Sum2 = 0;
+	tN2kAlertSnapshot Snapshot;
+	bool Result;
+
+	if (!Storage.Read(Address, Header, N2kAlertPersistenceHeaderSize)) return false;
+	if ((Header[0] | (Header[1] << 8)) != N2kAlertPersistenceMagic) return false;
+	if (Header[2] != N2kAlertPersistenceVersion) return false;
+	Count = Header[3] | (Header[4] << 8);
+	if ((Count != AlertCount) || (Count == 0)) return false;
+
+	Data = new uint8_t[(size_t)Count * N2kAlertSnapshotSize];
+	Result = Storage.Read(Address + N2kAlertPersistenceHeaderSize, Data, (size_t)Count * N2kAlertSnapshotSize);
+	if (Result) {
+		AddChecksum(Sum1, Sum2, Data, (size_t)Count * N2kAlertSnapshotSize);
+		Result = (((Sum2 << 8) | Sum1) == (Header[5] | (Header[6] << 8)));
+	}
+	if (Result) {
+		for (uint16_t i = 0; i < Count; i++) {
+			UnpackSnapshot(Data + (size_t)i * N2kAlertSnapshotSize, Snapshot);
+			Alerts[i]->RestoreSnapshot(Snapshot);
+		}
+		Checksum(_Checksum, SavedHash);
+	}
+	delete[] Data;
+	return Result;
+}
+
+// Writes the records that differ from the storage. The header with the new
+// checksum is written last.
+bool tN2kAlertPersistence::Save() {
+	tN2kAlertSnapshot Snapshot;
+	tN2kAlertSnapshot Stored;
+	uint16_t _Checksum;
+	uint32_t Hash;
+	bool Result = true;
+
+	Checksum(_Checksum, Hash);
+	for (uint16_t i = 0; i < AlertCount; i++) {
+		Alerts[i]->GetSnapshot(Snapshot);
+		if (ReadRecord(i, Stored) && (Stored.AlertId == Snapshot.AlertId) && (Stored.Occurence == Snapshot.Occurence) &&
+			(Stored.State == Snapshot.State) && (Stored.Flags == Snapshot.Flags)) continue;
+		Result &= WriteRecord(i, Snapshot);
+	}
+	Result &= WriteHeader(_Checksum);
+	Result &= Storage.Commit();
+	if (Result) SavedHash = Hash;
+	return Result;
+}
+
+void tN2kAlertPersistence::Handle() {
+	uint16_t _Checksum;
+	uint32_t Hash;
+
+	if (!WriteTimer.IsTime()) return;
+	WriteTimer.FromNow(WriteInterval);
+
+	Checksum(_Checksum, Hash);
+	if (Hash == SavedHash) return;
+	Save();
+}
@@ -0,0 +1,70 @@
+// N2kAlertPersistence.h
+
+#ifndef _N2KALERTPERSISTENCE_h
+#define _N2KALERTPERSISTENCE_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include "N2kAlerts.h"
+
+// Bytes used per alert in the storage
+#define N2kAlertSnapshotSize 5
+
+// Storage backend for the alert snapshot. Implement Read and Write for EEPROM,
+// NVS (Preferences), a file or any other non volatile memory. Commit is called
+// once after a group of writes, e.g. for EEPROM.commit() on ESP32.
+//
+//   class tEEPROMAlertStorage : public tN2kAlertStorage {
+//   public:
+//     bool Read(size_t Address, void* Data, size_t Size) { EEPROM.readBytes(Address, Data, Size); return true; }
+//     bool Write(size_t Address, const void* Data, size_t Size) { EEPROM.writeBytes(Address, Data, Size); return true; }
+//     bool Commit() { return EEPROM.commit(); }
+//   };
+class tN2kAlertStorage {
+public:
+	virtual ~tN2kAlertStorage() {}
+
+	virtual bool Read(size_t Address, void* Data, size_t Size) = 0;
+	virtual bool Write(size_t Address, const void* Data, size_t Size) = 0;
+	virtual bool Commit() { return true; }
+};
+
+// Saves the mutable state of a set of alerts and restores it after a reset.
+// The storage holds a small header followed by one N2kAlertSnapshotSize byte
+// record per alert, in the order of the alert list.
+//
+// Call Restore() in setup() before the first alert is sent and Handle() in
+// loop(). Handle() writes at most once per write interval, and only the records
+// that changed, to keep the wear on flash and EEPROM low.
+class tN2kAlertPersistence {
+public:
+	tN2kAlertPersistence(tN2kAlertStorage &_Storage, tN2kAlert** _Alerts, uint16_t _AlertCount, size_t _Address = 0);
+
+	void SetWriteInterval(uint32_t ms);
+	size_t GetStorageSize() const;
+
+	bool Restore();
+	bool Save();
+	void Handle();
+
+private:
+	tN2kAlertStorage &Storage;
+	tN2kAlert** Alerts;
+	uint16_t AlertCount;
+	size_t Address;
+
+	uint32_t WriteInterval;
+	tN2kScheduler WriteTimer;
+	uint32_t SavedHash;
+
+	void Checksum(uint16_t &_Checksum, uint32_t &Hash);
+	bool ReadRecord(uint16_t Index, tN2kAlertSnapshot &Snapshot);
+	bool WriteRecord(uint16_t Index, const tN2kAlertSnapshot &Snapshot);
+	bool WriteHeader(uint16_t _Checksum);
+};
+
+#endif
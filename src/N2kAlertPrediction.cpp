@@ -0,0 +1,72 @@
+//
+//
+//
+
+#include <math.h>
+#include "N2kAlertPrediction.h"
+
+#define N2kAlertPredictionMinSamples 3
+
+tN2kAlertPrediction::tN2kAlertPrediction(tN2kAlert &_Alert, uint32_t _Horizon, uint32_t _TimeConstant) :
+	Alert(_Alert),
+	Horizon(_Horizon),
+	TimeConstant(_TimeConstant > 0 ? _TimeConstant / 1000.0 : 0.001) {
+
+	Reset();
+}
+
+void tN2kAlertPrediction::Reset() {
+	S0 = St = Sv = Stt = Stv = 0;
+	Slope = 0;
+	LastTime = 0;
+	TimeToThreshold = 0xffffffffUL;
+	Count = 0;
+}
+
+tN2kAlertThresholdStatus tN2kAlertPrediction::Add(double Value, uint32_t Time) {
+	if (Count > 0) {
+		double dt = (uint32_t)(Time - LastTime) / 1000.0;
+		double Decay = exp(-dt / TimeConstant);
+
+		// Move the time axis to the new sample, then age the old samples
+		Stt = (Stt - 2 * dt * St + dt * dt * S0) * Decay;
+		Stv = (Stv - dt * Sv) * Decay;
+		St = (St - dt * S0) * Decay;
+		Sv *= Decay;
+		S0 *= Decay;
+	}
+	S0 += 1;
+	Sv += Value;
+	LastTime = Time;
+	if (Count < N2kAlertPredictionMinSamples) Count++;
+
+	double Denominator = S0 * Stt - St * St;
+	Slope = (Count >= N2kAlertPredictionMinSamples && Denominator > 0) ? (S0 * Stv - St * Sv) / Denominator : 0;
+
+	double Level = (double)Alert.GetAlertThresholdLevel();
+	double Distance, Rate;		// Towards the level
+
+	switch (Alert.GetAlertThresholdMethod()) {
+		case N2kts_AlertThresholddMethodGreater:
+			Distance = Level - Value;
+			Rate = Slope;
+			break;
+		case N2kts_AlertThresholdMethodLower:
+			Distance = Value - Level;
+			Rate = -Slope;
+			break;
+		default:
+			TimeToThreshold = 0xffffffffUL;
+			return Alert.TestAlertCondition(false);
+	}
+
+	if (Distance <= 0) {
+		TimeToThreshold = 0;
+	} else if (Rate > 0 && Distance / Rate < 4.0e6) {
+		TimeToThreshold = (uint32_t)(Distance / Rate * 1000);
+	} else {
+		TimeToThreshold = 0xffffffffUL;
+	}
+
+	return Alert.TestAlertCondition(TimeToThreshold <= Horizon);
+}
@@ -0,0 +1,57 @@
+// N2kAlertPrediction.h
+
+#ifndef _N2KALERTPREDICTION_h
+#define _N2KALERTPREDICTION_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include <N2kTimer.h>
+#include "N2kAlerts.h"
+
+// Early warning alert for slow values like battery SOC or tank levels. The
+// alert is raised with TestAlertCondition() when the value is already past
+// the threshold level of the alert, or when the trend line reaches the level
+// within Horizon ms. The Greater and Lower threshold methods are supported.
+//
+// The trend is an exponentially weighted least squares line with time
+// constant TimeConstant ms. Only the five weighted sums are kept, with the
+// time axis moved to the newest sample, so an update is O(1) with constant
+// memory per channel.
+//
+//   HouseBankLow.SetAlertThreshold(N2kts_AlertThresholdMethodLower, 0, 20);  // %
+//   tN2kAlertPrediction HouseBankPrediction(HouseBankLow, 3600000, 600000);  // 1 h warning
+//   on sample: HouseBankPrediction.Add(StateOfCharge);
+class tN2kAlertPrediction {
+public:
+	tN2kAlertPrediction(tN2kAlert &_Alert, uint32_t _Horizon, uint32_t _TimeConstant);
+
+	void Reset();
+
+	tN2kAlertThresholdStatus Add(double Value) { return Add(Value, N2kMillis()); }
+	// Time in ms
+	tN2kAlertThresholdStatus Add(double Value, uint32_t Time);
+
+	// Trend in value units per second
+	double GetSlope() const { return Slope; }
+	// Estimated ms until the level is reached, 0 if already past and
+	// 0xffffffff if the trend does not reach it
+	uint32_t GetTimeToThreshold() const { return TimeToThreshold; }
+
+private:
+	tN2kAlert &Alert;
+	uint32_t Horizon;
+	double TimeConstant;		// s
+
+	// Weighted sums with the newest sample at t = 0, t in s
+	double S0, St, Sv, Stt, Stv;
+	double Slope;
+	uint32_t LastTime;
+	uint32_t TimeToThreshold;
+	uint8_t Count;
+};
+
+#endif
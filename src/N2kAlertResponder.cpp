@@ -0,0 +1,178 @@
+//
+//
+//
+
+#include "N2kAlertResponder.h"
+
+// Frames of a fast packet message
+static uint8_t N2kAlertFrameCount(uint8_t DataLen) {
+	return (DataLen <= 8) ? 1 : 1 + (DataLen - 6 + 6) / 7;
+}
+
+tN2kAlertResponder::tN2kAlertResponder(tNMEA2000 &_NMEA2000, uint16_t _MaxCommands, uint64_t _AcknowledgeNetworkID, int _DeviceIndex) :
+	NMEA2000(_NMEA2000),
+	MaxCommands(_MaxCommands),
+	AcknowledgeNetworkID(_AcknowledgeNetworkID),
+	DeviceIndex(_DeviceIndex),
+	FrameBudget(20),
+	Interval(100),
+	ConfirmTimeout(5000),
+	IntervalTimer(0),
+	FramesLeft(20),
+	NextSequence(0),
+	QueuedCount(0),
+	SentCount(0),
+	ConfirmedCount(0),
+	UnconfirmedCount(0),
+	DuplicateCount(0) {
+
+	Commands = new tCommand[MaxCommands > 0 ? MaxCommands : 1];
+	for (uint16_t i = 0; i < MaxCommands; i++) Commands[i].State = N2kAlertCommandFree;
+}
+
+tN2kAlertResponder::~tN2kAlertResponder() {
+	delete[] Commands;
+}
+
+void tN2kAlertResponder::SetPacing(uint8_t _FrameBudget, uint32_t _Interval) {
+	FrameBudget = (_FrameBudget > 0) ? _FrameBudget : 1;
+	Interval = _Interval;
+	FramesLeft = FrameBudget;
+	IntervalTimer.FromNow(Interval);
+}
+
+// Commands that are queued or sent count as duplicates
+int tN2kAlertResponder::Find(const tN2kAlertUID &UID, uint8_t Command) const {
+	for (uint16_t i = 0; i < MaxCommands; i++) {
+		const tCommand &c = Commands[i];
+		if ((c.State != N2kAlertCommandFree) && (c.Command == Command) && (c.Key.UID == UID)) return i;
+	}
+	return -1;
+}
+
+// A free slot, else the one of the oldest finished command
+int tN2kAlertResponder::FindFreeSlot() const {
+	int Best = -1;
+
+	for (uint16_t i = 0; i < MaxCommands; i++) {
+		const tCommand &c = Commands[i];
+		if (c.State == N2kAlertCommandFree) return i;
+		if ((c.State == N2kAlertCommandConfirmed) || (c.State == N2kAlertCommandUnconfirmed)) {
+			if ((Best < 0) || ((int16_t)(c.Sequence - Commands[Best].Sequence) < 0)) Best = i;
+		}
+	}
+	return Best;
+}
+
+int tN2kAlertResponder::FindOldestQueued() const {
+	int Best = -1;
+
+	for (uint16_t i = 0; i < MaxCommands; i++) {
+		const tCommand &c = Commands[i];
+		if (c.State != N2kAlertCommandQueued) continue;
+		if ((Best < 0) || ((int16_t)(c.Sequence - Commands[Best].Sequence) < 0)) Best = i;
+	}
+	return Best;
+}
+
+bool tN2kAlertResponder::Queue(const tN2kAlertKey &Key, tN2kAlertResponseCommand Command) {
+	tN2kAlertUID UID = N2kAlertUID(Key);
+	int i = Find(UID, Command);
+
+	if (i >= 0) {
+		uint8_t State = Commands[i].State;
+		if ((State == N2kAlertCommandQueued) || (State == N2kAlertCommandSent)) {
+			DuplicateCount++;
+			return true;
+		}
+		// Finished, the slot is reused for the new command
+	} else {
+		i = FindFreeSlot();
+		if (i < 0) return false;
+	}
+
+	tCommand &c = Commands[i];
+	c.Key = Key;
+	c.Key.UID = UID;
+	c.Command = Command;
+	c.Sequence = NextSequence++;
+	c.SentTime = 0;
+	c.State = N2kAlertCommandQueued;
+	QueuedCount++;
+	return true;
+}
+
+tN2kAlertCommandState tN2kAlertResponder::GetState(const tN2kAlertKey &Key, tN2kAlertResponseCommand Command) const {
+	int i = Find(N2kAlertUID(Key), Command);
+	return (i >= 0) ? tN2kAlertCommandState(Commands[i].State) : N2kAlertCommandFree;
+}
+
+bool tN2kAlertResponder::Send(tCommand &Command) {
+	tN2kAlertResponse Response;
+	tN2kMsg N2kMsg;
+
+	Response.Key = Command.Key;
+	Response.AcknowledgeNetworkID = AcknowledgeNetworkID;
+	Response.ResponseCommand = tN2kAlertResponseCommand(Command.Command);
+	SetN2kAlertReponse(N2kMsg, Response);
+
+	// A budget smaller than one message still lets one message per interval
+	uint8_t Frames = N2kAlertFrameCount(N2kMsg.DataLen);
+	if ((Frames > FramesLeft) && (FramesLeft < FrameBudget)) return false;
+	if (!NMEA2000.SendMsg(N2kMsg, DeviceIndex)) return false;
+	FramesLeft = (Frames < FramesLeft) ? FramesLeft - Frames : 0;
+	return true;
+}
+
+void tN2kAlertResponder::Handle() {
+	if (IntervalTimer.IsTime()) {
+		IntervalTimer.FromNow(Interval);
+		FramesLeft = FrameBudget;
+	}
+
+	while (QueuedCount > 0) {
+		int i = FindOldestQueued();
+		if (i < 0) {
+			QueuedCount = 0;
+			break;
+		}
+		// Stops at the budget or a full send buffer, the command stays first
+		if (!Send(Commands[i])) break;
+		Commands[i].State = N2kAlertCommandSent;
+		Commands[i].SentTime = N2kMillis();
+		QueuedCount--;
+		SentCount++;
+	}
+
+	if (SentCount == 0) return;
+	uint32_t Now = N2kMillis();
+	for (uint16_t i = 0; i < MaxCommands; i++) {
+		tCommand &c = Commands[i];
+		if ((c.State == N2kAlertCommandSent) && (Now - c.SentTime >= ConfirmTimeout)) {
+			c.State = N2kAlertCommandUnconfirmed;
+			SentCount--;
+			UnconfirmedCount++;
+		}
+	}
+}
+
+bool tN2kAlertResponder::HandleMsg(const tN2kMsg &N2kMsg) {
+	tN2kAlertNotification Notification;
+	bool Result = false;
+
+	if ((N2kMsg.PGN != 126983L) || (SentCount == 0)) return false;
+	if (!ParseN2kAlert(N2kMsg, Notification)) return false;
+
+	for (uint16_t i = 0; i < MaxCommands; i++) {
+		tCommand &c = Commands[i];
+		if ((c.State != N2kAlertCommandSent) || !(c.Key.UID == Notification.Key.UID)) continue;
+		if (((c.Command == N2kts_AlertResponseAcknowledge) && (Notification.AcknowledgeStatus == N2kts_AlertYes)) ||
+			((c.Command == N2kts_AlertResponseTemporarySilence) && (Notification.TemporarySilenceStatus == N2kts_AlertYes))) {
+			c.State = N2kAlertCommandConfirmed;
+			SentCount--;
+			ConfirmedCount++;
+			Result = true;
+		}
+	}
+	return Result;
+}
@@ -0,0 +1,98 @@
+// N2kAlertResponder.h
+
+#ifndef _N2KALERTRESPONDER_h
+#define _N2KALERTRESPONDER_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include <NMEA2000.h>
+#include "N2kAlertMessages.h"
+
+enum tN2kAlertCommandState {
+	N2kAlertCommandFree = 0,
+	N2kAlertCommandQueued = 1,		// Waiting for the frame budget
+	N2kAlertCommandSent = 2,		// Waiting for the confirming 126983
+	N2kAlertCommandConfirmed = 3,
+	N2kAlertCommandUnconfirmed = 4	// No confirmation within the confirm timeout
+};
+
+// Sends 126984 alert responses for alerts of other devices, e.g. "acknowledge
+// all" on a display.
+//
+// Commands are queued and sent in order within a budget of CAN frames per
+// interval, so a batch of dozens of responses does not flood the bus. A
+// command for an alert that is already queued or waiting for confirmation
+// with the same command is dropped. A sent command is confirmed when a later
+// 126983 of the alert shows it acknowledged or silenced; feed received
+// messages to HandleMsg(). Test commands are never confirmed and end as
+// unconfirmed. Finished commands keep their state until their slot is needed
+// for a new command.
+//
+//   tN2kAlertResponder AlertResponder(NMEA2000, 32, DisplayName);
+//   for each alert: AlertResponder.Queue(Notification.Key, N2kts_AlertResponseAcknowledge);
+//   loop(): AlertResponder.Handle();
+//   void HandleNMEA2000Msg(const tN2kMsg &N2kMsg) { AlertResponder.HandleMsg(N2kMsg); }
+class tN2kAlertResponder {
+public:
+	tN2kAlertResponder(tNMEA2000 &_NMEA2000, uint16_t _MaxCommands, uint64_t _AcknowledgeNetworkID, int _DeviceIndex = 0);
+	~tN2kAlertResponder();
+
+	tN2kAlertResponder(const tN2kAlertResponder&) = delete;
+	tN2kAlertResponder &operator=(const tN2kAlertResponder&) = delete;
+
+	void SetPacing(uint8_t _FrameBudget, uint32_t _Interval);
+	void SetConfirmTimeout(uint32_t _ConfirmTimeout) { ConfirmTimeout = _ConfirmTimeout; }
+
+	// Returns false if there is no free slot. A dropped duplicate returns true.
+	bool Queue(const tN2kAlertKey &Key, tN2kAlertResponseCommand Command);
+	tN2kAlertCommandState GetState(const tN2kAlertKey &Key, tN2kAlertResponseCommand Command) const;
+
+	uint16_t GetQueuedCount() const { return QueuedCount; }
+	uint16_t GetSentCount() const { return SentCount; }
+	uint32_t GetConfirmedCount() const { return ConfirmedCount; }
+	uint32_t GetUnconfirmedCount() const { return UnconfirmedCount; }
+	uint32_t GetDuplicateCount() const { return DuplicateCount; }
+
+	void Handle();
+	// Returns true if the message confirmed a command
+	bool HandleMsg(const tN2kMsg &N2kMsg);
+
+private:
+	struct tCommand {
+		tN2kAlertKey Key;
+		uint32_t SentTime;
+		uint16_t Sequence;		// Queue order
+		uint8_t Command;
+		uint8_t State;
+	};
+
+	tNMEA2000 &NMEA2000;
+	tCommand* Commands;
+	uint16_t MaxCommands;
+	uint64_t AcknowledgeNetworkID;
+	int DeviceIndex;
+
+	uint8_t FrameBudget;
+	uint32_t Interval;
+	uint32_t ConfirmTimeout;
+	tN2kScheduler IntervalTimer;
+	uint8_t FramesLeft;
+
+	uint16_t NextSequence;
+	uint16_t QueuedCount;
+	uint16_t SentCount;
+	uint32_t ConfirmedCount;
+	uint32_t UnconfirmedCount;
+	uint32_t DuplicateCount;
+
+	int Find(const tN2kAlertUID &UID, uint8_t Command) const;
+	int FindOldestQueued() const;
+	int FindFreeSlot() const;
+	bool Send(tCommand &Command);
+};
+
+#endif
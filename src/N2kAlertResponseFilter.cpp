@@ -0,0 +1,47 @@
+//
+//
+//
+
+#include <N2kTimer.h>
+#include "N2kAlertResponseFilter.h"
+
+tN2kAlertResponseFilter::tN2kAlertResponseFilter(uint16_t _Size, uint32_t _Window) :
+	Window(_Window),
+	RepeatCount(0) {
+
+	uint16_t Size = 1;
+	while ((Size < _Size) && (Size < 0x8000)) Size <<= 1;
+	Mask = Size - 1;
+	Entries = new tEntry[Size];
+	Clear();
+}
+
+tN2kAlertResponseFilter::~tN2kAlertResponseFilter() {
+	delete[] Entries;
+}
+
+void tN2kAlertResponseFilter::Clear() {
+	for (uint16_t i = 0; i <= Mask; i++) Entries[i].Used = false;
+}
+
+bool tN2kAlertResponseFilter::IsRepeat(const tN2kAlertResponse &Response) {
+	uint32_t Hash = Response.Key.UID.Hash() ^ (uint32_t)(Response.AcknowledgeNetworkID * 0x9E3779B97F4A7C15ULL >> 32) ^
+		((uint32_t)Response.Key.AlertOccurence << 8) ^ (uint32_t)Response.ResponseCommand;
+	tEntry &Entry = Entries[(Hash ^ (Hash >> 16)) & Mask];
+	uint32_t Now = N2kMillis();
+
+	if (Entry.Used && (Now - Entry.Time < Window) && (Entry.UID == Response.Key.UID) &&
+		(Entry.AcknowledgeNetworkID == Response.AcknowledgeNetworkID) && (Entry.Occurence == Response.Key.AlertOccurence) &&
+		(Entry.Command == Response.ResponseCommand)) {
+		RepeatCount++;
+		return true;
+	}
+
+	Entry.UID = Response.Key.UID;
+	Entry.AcknowledgeNetworkID = Response.AcknowledgeNetworkID;
+	Entry.Time = Now;
+	Entry.Occurence = Response.Key.AlertOccurence;
+	Entry.Command = Response.ResponseCommand;
+	Entry.Used = true;
+	return false;
+}
@@ -0,0 +1,56 @@
+// N2kAlertResponseFilter.h
+
+#ifndef _N2KALERTRESPONSEFILTER_h
+#define _N2KALERTRESPONSEFILTER_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include "N2kAlertMessages.h"
+
+// Cache of recently handled 126984 responses. Several displays often answer
+// one crew action with identical responses; a response with the same alert,
+// occurence, command and acknowledging NAME as one seen within Window ms is
+// a repeat.
+//
+// The cache is direct mapped: the hash of the response selects one slot, so
+// a lookup is O(1) with Size slots of fixed memory. Two responses mapping to
+// the same slot replace each other, then a repeat is handled once more.
+//
+//   tN2kAlertResponseFilter AlertResponseFilter(16, 2000);
+//   setup(): TemperatureAlert.SetResponseFilter(&AlertResponseFilter);
+class tN2kAlertResponseFilter {
+public:
+	// Size is rounded up to a power of two
+	tN2kAlertResponseFilter(uint16_t _Size = 16, uint32_t _Window = 2000);
+	~tN2kAlertResponseFilter();
+
+	tN2kAlertResponseFilter(const tN2kAlertResponseFilter&) = delete;
+	tN2kAlertResponseFilter &operator=(const tN2kAlertResponseFilter&) = delete;
+
+	// Returns true for a repeat. Otherwise the response is recorded.
+	bool IsRepeat(const tN2kAlertResponse &Response);
+	void Clear();
+
+	uint32_t GetRepeatCount() const { return RepeatCount; }
+
+private:
+	struct tEntry {
+		tN2kAlertUID UID;
+		uint64_t AcknowledgeNetworkID;
+		uint32_t Time;
+		uint8_t Occurence;
+		uint8_t Command;
+		bool Used;
+	};
+
+	tEntry* Entries;
+	uint16_t Mask;
+	uint32_t Window;
+	uint32_t RepeatCount;
+};
+
+#endif
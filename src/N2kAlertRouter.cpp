@@ -0,0 +1,153 @@
+//
+//
+//
+
+#include "N2kAlertRouter.h"
+
+static bool FieldOfPGN(uint32_t PGN, tN2kAlertField Field) {
+	switch (PGN) {
+		case 130312:
+		case 130316:
+			return (Field == N2kAlertFieldTemperature) || (Field == N2kAlertFieldSetTemperature);
+		case 127505:
+			return (Field == N2kAlertFieldFluidLevel) || (Field == N2kAlertFieldFluidCapacity);
+		case 127488:
+			return (Field >= N2kAlertFieldEngineSpeed) && (Field <= N2kAlertFieldEngineTiltTrim);
+		case 127489:
+			return (Field >= N2kAlertFieldEngineOilPressure) && (Field <= N2kAlertFieldEngineTorque);
+	}
+	return false;
+}
+
+static inline uint64_t BindingKey(uint32_t PGN, uint8_t Source, uint8_t Instance) {
+	return ((uint64_t)PGN << 16) | ((uint16_t)Source << 8) | Instance;
+}
+
+static inline double Int8Value(int8_t v) {
+	return (v == N2kInt8NA) ? N2kDoubleNA : v;
+}
+
+tN2kAlertRouter::tN2kAlertRouter(uint16_t _MaxBindings) :
+	MaxBindings(_MaxBindings),
+	BindingCount(0) {
+
+	Bindings = new tBinding[MaxBindings > 0 ? MaxBindings : 1];
+}
+
+tN2kAlertRouter::~tN2kAlertRouter() {
+	delete[] Bindings;
+}
+
+// First binding with a key not less than the given key
+uint16_t tN2kAlertRouter::LowerBound(uint32_t PGN, uint8_t Source, uint8_t Instance) const {
+	uint64_t Key = BindingKey(PGN, Source, Instance);
+	uint16_t First = 0;
+	uint16_t Last = BindingCount;
+
+	while (First < Last) {
+		uint16_t Middle = First + (Last - First) / 2;
+		if (BindingKey(Bindings[Middle].PGN, Bindings[Middle].Source, Bindings[Middle].Instance) < Key) {
+			First = Middle + 1;
+		}
+		else {
+			Last = Middle;
+		}
+	}
+	return First;
+}
+
+bool tN2kAlertRouter::Bind(tN2kAlert &Alert, unsigned long PGN, tN2kAlertField Field, uint8_t Source, uint8_t Instance, double Scale, double Offset) {
+	if ((BindingCount >= MaxBindings) || !FieldOfPGN(PGN, Field)) return false;
+
+	uint16_t Index = LowerBound(PGN, Source, Instance);
+	for (uint16_t i = BindingCount; i > Index; i--) Bindings[i] = Bindings[i - 1];
+	Bindings[Index].PGN = PGN;
+	Bindings[Index].Source = Source;
+	Bindings[Index].Instance = Instance;
+	Bindings[Index].Field = Field;
+	Bindings[Index].Alert = &Alert;
+	Bindings[Index].Scale = Scale;
+	Bindings[Index].Offset = Offset;
+	BindingCount++;
+	return true;
+}
+
+void tN2kAlertRouter::Unbind(tN2kAlert &Alert) {
+	uint16_t j = 0;
+
+	for (uint16_t i = 0; i < BindingCount; i++) {
+		if (Bindings[i].Alert != &Alert) Bindings[j++] = Bindings[i];
+	}
+	BindingCount = j;
+}
+
+uint16_t tN2kAlertRouter::Route(uint32_t PGN, uint8_t Source, uint8_t Instance, const double* Values) {
+	uint16_t Routed = 0;
+
+	for (uint16_t i = LowerBound(PGN, Source, Instance);
+		(i < BindingCount) && (Bindings[i].PGN == PGN) && (Bindings[i].Source == Source) && (Bindings[i].Instance == Instance); i++) {
+		const tBinding &Binding = Bindings[i];
+		double v = Values[Binding.Field];
+
+		if (N2kIsNA(v)) continue;
+		v = v * Binding.Scale + Binding.Offset;
+		Binding.Alert->TestAlertThreshold((v > 0) ? (uint64_t)v : 0);
+		Routed++;
+	}
+	return Routed;
+}
+
+bool tN2kAlertRouter::HandleMsg(const tN2kMsg &N2kMsg) {
+	double Values[N2kAlertFieldCount];
+	unsigned char Instance;
+	unsigned char SID;
+	uint16_t Routed;
+
+	if (BindingCount == 0) return false;
+
+	// Skip messages without a binding before they are parsed
+	uint16_t First = LowerBound(N2kMsg.PGN, 0, 0);
+	if ((First >= BindingCount) || (Bindings[First].PGN != N2kMsg.PGN)) return false;
+
+	switch (N2kMsg.PGN) {
+		case 130312:
+		case 130316: {
+			tN2kTempSource TempSource;
+			bool Parsed = (N2kMsg.PGN == 130312) ?
+				ParseN2kPGN130312(N2kMsg, SID, Instance, TempSource, Values[N2kAlertFieldTemperature], Values[N2kAlertFieldSetTemperature]) :
+				ParseN2kPGN130316(N2kMsg, SID, Instance, TempSource, Values[N2kAlertFieldTemperature], Values[N2kAlertFieldSetTemperature]);
+			if (!Parsed) return false;
+			break;
+		}
+		case 127505: {
+			tN2kFluidType FluidType;
+			if (!ParseN2kPGN127505(N2kMsg, Instance, FluidType, Values[N2kAlertFieldFluidLevel], Values[N2kAlertFieldFluidCapacity])) return false;
+			break;
+		}
+		case 127488: {
+			int8_t TiltTrim;
+			if (!ParseN2kPGN127488(N2kMsg, Instance, Values[N2kAlertFieldEngineSpeed], Values[N2kAlertFieldEngineBoostPressure], TiltTrim)) return false;
+			Values[N2kAlertFieldEngineTiltTrim] = Int8Value(TiltTrim);
+			break;
+		}
+		case 127489: {
+			int8_t Load;
+			int8_t Torque;
+			tN2kEngineDiscreteStatus1 Status1;
+			tN2kEngineDiscreteStatus2 Status2;
+			if (!ParseN2kPGN127489(N2kMsg, Instance, Values[N2kAlertFieldEngineOilPressure], Values[N2kAlertFieldEngineOilTemperature],
+				Values[N2kAlertFieldEngineCoolantTemperature], Values[N2kAlertFieldAlternatorVoltage], Values[N2kAlertFieldFuelRate],
+				Values[N2kAlertFieldEngineHours], Values[N2kAlertFieldEngineCoolantPressure], Values[N2kAlertFieldEngineFuelPressure],
+				Load, Torque, Status1, Status2)) return false;
+			Values[N2kAlertFieldEngineLoad] = Int8Value(Load);
+			Values[N2kAlertFieldEngineTorque] = Int8Value(Torque);
+			break;
+		}
+		default:
+			return false;
+	}
+
+	Routed = Route(N2kMsg.PGN, N2kMsg.Source, Instance, Values);
+	if (N2kMsg.Source != N2kAlertSourceAny) Routed += Route(N2kMsg.PGN, N2kAlertSourceAny, Instance, Values);
+	return Routed > 0;
+}
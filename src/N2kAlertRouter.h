@@ -0,0 +1,91 @@
+// N2kAlertRouter.h
+
+#ifndef _N2KALERTROUTER_h
+#define _N2KALERTROUTER_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include <N2kMessages.h>
+#include "N2kAlerts.h"
+
+// Sensor values an alert can be bound to, in SI units as returned by the
+// NMEA2000 library parse functions
+enum tN2kAlertField {
+	N2kAlertFieldTemperature = 0,			// 130312, 130316: actual temperature, K
+	N2kAlertFieldSetTemperature = 1,		// 130312, 130316: set temperature, K
+	N2kAlertFieldFluidLevel = 2,			// 127505: %
+	N2kAlertFieldFluidCapacity = 3,			// 127505: l
+	N2kAlertFieldEngineSpeed = 4,			// 127488: rpm
+	N2kAlertFieldEngineBoostPressure = 5,	// 127488: Pa
+	N2kAlertFieldEngineTiltTrim = 6,		// 127488: %
+	N2kAlertFieldEngineOilPressure = 7,		// 127489: Pa
+	N2kAlertFieldEngineOilTemperature = 8,	// 127489: K
+	N2kAlertFieldEngineCoolantTemperature = 9,	// 127489: K
+	N2kAlertFieldAlternatorVoltage = 10,	// 127489: V
+	N2kAlertFieldFuelRate = 11,				// 127489: l/h
+	N2kAlertFieldEngineHours = 12,			// 127489: s
+	N2kAlertFieldEngineCoolantPressure = 13,	// 127489: Pa
+	N2kAlertFieldEngineFuelPressure = 14,	// 127489: Pa
+	N2kAlertFieldEngineLoad = 15,			// 127489: %
+	N2kAlertFieldEngineTorque = 16,			// 127489: %
+	N2kAlertFieldCount = 17
+};
+
+// Any source address
+#define N2kAlertSourceAny 0xff
+
+// Evaluates alerts directly from received sensor PGNs. Each binding connects
+// one field of a PGN from a source address and instance to an alert. The
+// value passed to TestAlertThreshold() is Value * Scale + Offset, so the
+// threshold of the alert is set in the same scaled integer unit, e.g.
+// Scale 100, Offset -27315 for 0.01 degC from a temperature in K. Negative
+// results are passed as 0.
+//
+// The bindings are kept sorted by (PGN, source, instance), so a received
+// message is parsed once and its bindings are found with a binary search.
+//
+//   tN2kAlertRouter AlertRouter(8);
+//   AlertRouter.Bind(EngineRoomAlert, 130312, N2kAlertFieldTemperature, N2kAlertSourceAny, 1, 100, -27315);
+//
+//   void HandleNMEA2000Msg(const tN2kMsg &N2kMsg) { AlertRouter.HandleMsg(N2kMsg); }
+class tN2kAlertRouter {
+public:
+	tN2kAlertRouter(uint16_t _MaxBindings);
+	~tN2kAlertRouter();
+
+	tN2kAlertRouter(const tN2kAlertRouter&) = delete;
+	tN2kAlertRouter &operator=(const tN2kAlertRouter&) = delete;
+
+	// Returns false if the field does not belong to the PGN or all bindings
+	// are used
+	bool Bind(tN2kAlert &Alert, unsigned long PGN, tN2kAlertField Field, uint8_t Source, uint8_t Instance, double Scale = 1, double Offset = 0);
+	void Unbind(tN2kAlert &Alert);
+	uint16_t GetBindingCount() const { return BindingCount; }
+
+	// Returns true if the message was routed to at least one alert
+	bool HandleMsg(const tN2kMsg &N2kMsg);
+
+private:
+	struct tBinding {
+		uint32_t PGN;
+		uint8_t Source;
+		uint8_t Instance;
+		uint8_t Field;
+		tN2kAlert* Alert;
+		double Scale;
+		double Offset;
+	};
+
+	tBinding* Bindings;
+	uint16_t MaxBindings;
+	uint16_t BindingCount;
+
+	uint16_t LowerBound(uint32_t PGN, uint8_t Source, uint8_t Instance) const;
+	uint16_t Route(uint32_t PGN, uint8_t Source, uint8_t Instance, const double* Values);
+};
+
+#endif
@@ -0,0 +1,92 @@
+// N2kAlertSampleQueue.h
+
+#ifndef _N2KALERTSAMPLEQUEUE_h
+#define _N2KALERTSAMPLEQUEUE_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include "N2kAlerts.h"
+#include "N2kAlertAtomic.h"
+
+// Single producer / single consumer ring of sensor samples for alerts.
+//
+// On multi core systems the sensor task pushes samples with Push() and the
+// task that owns the alerts (the one calling NMEA2000.ParseMessages() and
+// sending the alert messages) calls Drain() in its loop. The alerts are then
+// only touched by one task and the sensor task never waits on a lock.
+//
+// The handle of a sample is the index of the alert in the list passed to
+// Drain(). Size must be a power of two. When the ring is full, new samples are
+// dropped and counted; see GetDropped().
+//
+//   tN2kAlert* Alerts[] = { &TemperatureAlert, &PressureAlert };
+//   tN2kAlertSampleQueue<32> AlertSamples;
+//
+//   SensorTask:  AlertSamples.Push(0, Temperature);
+//   loop():      AlertSamples.Drain(Alerts, 2);
+template<uint16_t Size> class tN2kAlertSampleQueue {
+	static_assert((Size >= 2) && (Size <= 32768) && ((Size & (Size - 1)) == 0), "Size must be a power of two");
+
+public:
+	struct tSample {
+		uint16_t Handle;
+		uint64_t Value;
+	};
+
+	tN2kAlertSampleQueue() : Head(0), Tail(0), Dropped(0) {}
+
+	// Producer side
+	bool Push(uint16_t Handle, uint64_t Value) {
+		uint16_t _Head = Head;
+		if ((uint16_t)(_Head - N2kAlertAtomicLoad(Tail)) >= Size) {
+			N2kAlertAtomicStore(Dropped, (uint32_t)(Dropped + 1));
+			return false;
+		}
+		Samples[_Head & (Size - 1)].Handle = Handle;
+		Samples[_Head & (Size - 1)].Value = Value;
+		N2kAlertAtomicStore(Head, (uint16_t)(_Head + 1));
+		return true;
+	}
+
+	// Consumer side
+	bool Pop(tSample &Sample) {
+		uint16_t _Tail = Tail;
+		if (_Tail == N2kAlertAtomicLoad(Head)) return false;
+		Sample = Samples[_Tail & (Size - 1)];
+		N2kAlertAtomicStore(Tail, (uint16_t)(_Tail + 1));
+		return true;
+	}
+
+	// Consumer side. Feeds up to MaxSamples queued samples to their alerts with
+	// TestAlertThreshold and returns the number of samples handled. The
+	// producer index is read once and the consumer index written once per call.
+	uint16_t Drain(tN2kAlert** Alerts, uint16_t AlertCount, uint16_t MaxSamples = Size) {
+		uint16_t _Tail = Tail;
+		uint16_t Count = N2kAlertAtomicLoad(Head) - _Tail;
+
+		if (Count > MaxSamples) Count = MaxSamples;
+		for (uint16_t i = 0; i < Count; i++) {
+			const tSample &Sample = Samples[(uint16_t)(_Tail + i) & (Size - 1)];
+			if (Sample.Handle < AlertCount) {
+				Alerts[Sample.Handle]->TestAlertThreshold(Sample.Value);
+			}
+		}
+		if (Count > 0) N2kAlertAtomicStore(Tail, (uint16_t)(_Tail + Count));
+		return Count;
+	}
+
+	uint16_t GetCount() const { return (uint16_t)(N2kAlertAtomicLoad(Head) - N2kAlertAtomicLoad(Tail)); }
+	uint32_t GetDropped() const { return N2kAlertAtomicLoad(Dropped); }
+
+private:
+	tSample Samples[Size];
+	volatile uint16_t Head;
+	volatile uint16_t Tail;
+	volatile uint32_t Dropped;
+};
+
+#endif
@@ -0,0 +1,153 @@
+//
+//
+//
+
+#include "N2kAlertStatistics.h"
+
+#define N2kAlertStatisticsVersion 1
+
+static uint8_t* PutUInt(uint8_t* p, uint64_t v, uint8_t Bytes) {
+	for (uint8_t i = 0; i < Bytes; i++, v >>= 8) *p++ = v & 0xff;
+	return p;
+}
+
+static uint64_t GetUInt(const uint8_t* &p, uint8_t Bytes) {
+	uint64_t v = 0;
+	for (uint8_t i = 0; i < Bytes; i++) v |= (uint64_t)(*p++) << (8 * i);
+	return v;
+}
+
+static uint8_t LatencyBucket(uint64_t ms) {
+	uint64_t s = ms / 1000;
+	uint8_t Bucket = 0;
+
+	while ((s > 0) && (Bucket < N2kAlertStatisticsBuckets - 1)) {
+		s >>= 1;
+		Bucket++;
+	}
+	return Bucket;
+}
+
+tN2kAlertStatistics::tN2kAlertStatistics() :
+	CurrentState(N2kts_AlertStateNormal),
+	StateSince(0),
+	OccurenceStart(0),
+	AwaitingResponse(false) {
+
+	Reset();
+}
+
+bool tN2kAlertStatistics::Attach(tN2kAlert &Alert) {
+	tN2kAlertStatus AlertStatus;
+
+	Alert.GetAlertStatus(AlertStatus);
+	CurrentState = AlertStatus.AlertState;
+	StateSince = N2kMillis64();
+	return Alert.AttachTransitionHandler(OnTransition, this);
+}
+
+void tN2kAlertStatistics::Reset() {
+	for (uint8_t i = 0; i < N2kAlertStatisticsStates; i++) StateTime[i] = 0;
+	OccurenceCount = 0;
+	IntervalSum = 0;
+	IntervalCount = 0;
+	ResponseCount = 0;
+	ResponseSum = 0;
+	for (uint8_t i = 0; i < N2kAlertStatisticsBuckets; i++) ResponseHistogram[i] = 0;
+	StateSince = N2kMillis64();
+	OccurenceStart = 0;
+	AwaitingResponse = false;
+}
+
+void tN2kAlertStatistics::OnTransition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus, void* Context) {
+	((tN2kAlertStatistics*)Context)->Transition(OldStatus, NewStatus);
+}
+
+void tN2kAlertStatistics::Transition(const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus) {
+	uint64_t Now = N2kMillis64();
+
+	if (CurrentState < N2kAlertStatisticsStates) StateTime[CurrentState] += Now - StateSince;
+	CurrentState = NewStatus.AlertState;
+	StateSince = Now;
+
+	if (NewStatus.Occurence != OldStatus.Occurence) {
+		OccurenceCount++;
+		if (OccurenceStart != 0) {
+			IntervalSum += Now - OccurenceStart;
+			IntervalCount++;
+		}
+		OccurenceStart = Now;
+		AwaitingResponse = true;
+	}
+
+	if (AwaitingResponse &&
+		(((NewStatus.AcknowledgeStatus == N2kts_AlertYes) && (OldStatus.AcknowledgeStatus != N2kts_AlertYes)) ||
+		 ((NewStatus.TemporarySilenceStatus == N2kts_AlertYes) && (OldStatus.TemporarySilenceStatus != N2kts_AlertYes)))) {
+		uint64_t Latency = Now - OccurenceStart;
+		uint16_t &Count = ResponseHistogram[LatencyBucket(Latency)];
+		ResponseCount++;
+		ResponseSum += Latency;
+		if (Count < 0xffff) Count++;
+		AwaitingResponse = false;
+	}
+}
+
+uint64_t tN2kAlertStatistics::GetTimeInState(tN2kAlertState AlertState) const {
+	if (AlertState >= N2kAlertStatisticsStates) return 0;
+	if (AlertState == CurrentState) return StateTime[AlertState] + (N2kMillis64() - StateSince);
+	return StateTime[AlertState];
+}
+
+uint32_t tN2kAlertStatistics::GetMeanTimeBetweenOccurences() const {
+	return (IntervalCount > 0) ? (uint32_t)(IntervalSum / IntervalCount) : 0;
+}
+
+uint32_t tN2kAlertStatistics::GetMeanResponseLatency() const {
+	return (ResponseCount > 0) ? (uint32_t)(ResponseSum / ResponseCount) : 0;
+}
+
+uint16_t tN2kAlertStatistics::GetResponseLatencyCount(uint8_t Bucket) const {
+	return (Bucket < N2kAlertStatisticsBuckets) ? ResponseHistogram[Bucket] : 0;
+}
+
+// Writes N2kAlertStatisticsSize bytes, little endian. Returns 0 if Buffer is
+// too small.
+size_t tN2kAlertStatistics::Serialize(uint8_t* Buffer, size_t Size) const {
+	uint8_t* p = Buffer;
+
+	if (Size < N2kAlertStatisticsSize) return 0;
+	*p++ = N2kAlertStatisticsVersion;
+	for (uint8_t i = 0; i < N2kAlertStatisticsStates; i++) {
+		p = PutUInt(p, GetTimeInState(tN2kAlertState(i)), 8);
+	}
+	p = PutUInt(p, OccurenceCount, 4);
+	p = PutUInt(p, IntervalSum, 8);
+	p = PutUInt(p, IntervalCount, 4);
+	p = PutUInt(p, ResponseCount, 4);
+	p = PutUInt(p, ResponseSum, 8);
+	for (uint8_t i = 0; i < N2kAlertStatisticsBuckets; i++) {
+		p = PutUInt(p, ResponseHistogram[i], 2);
+	}
+	return p - Buffer;
+}
+
+bool tN2kAlertStatistics::Deserialize(const uint8_t* Buffer, size_t Size) {
+	const uint8_t* p = Buffer;
+
+	if ((Size < N2kAlertStatisticsSize) || (*p++ != N2kAlertStatisticsVersion)) return false;
+	for (uint8_t i = 0; i < N2kAlertStatisticsStates; i++) {
+		StateTime[i] = GetUInt(p, 8);
+	}
+	OccurenceCount = GetUInt(p, 4);
+	IntervalSum = GetUInt(p, 8);
+	IntervalCount = GetUInt(p, 4);
+	ResponseCount = GetUInt(p, 4);
+	ResponseSum = GetUInt(p, 8);
+	for (uint8_t i = 0; i < N2kAlertStatisticsBuckets; i++) {
+		ResponseHistogram[i] = GetUInt(p, 2);
+	}
+	StateSince = N2kMillis64();
+	OccurenceStart = 0;
+	AwaitingResponse = false;
+	return true;
+}
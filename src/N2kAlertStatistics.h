@@ -0,0 +1,75 @@
+// N2kAlertStatistics.h
+
+#ifndef _N2KALERTSTATISTICS_h
+#define _N2KALERTSTATISTICS_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include "N2kAlerts.h"
+
+// Number of alert states, N2kts_AlertStateDisabled ... N2kts_AlertStateAwaitingAcknowledge
+#define N2kAlertStatisticsStates 6
+// Response latency buckets. Bucket 0 counts responses within 1 s, bucket i
+// responses within [2^(i-1), 2^i) s and the last bucket all slower ones.
+#define N2kAlertStatisticsBuckets 16
+// Bytes used by Serialize()
+#define N2kAlertStatisticsSize (1 + N2kAlertStatisticsStates * 8 + 4 + 8 + 4 + 4 + 8 + N2kAlertStatisticsBuckets * 2)
+
+// Statistics of one alert, updated by its transition handler in O(1) with
+// fixed memory:
+//  - total time spent in each alert state
+//  - number of occurences and the mean time between them
+//  - number of responses (acknowledge or silence) and a histogram of the
+//    time from the start of an occurence to the first response
+//
+//   tN2kAlertStatistics TemperatureStatistics;
+//   TemperatureStatistics.Attach(TemperatureAlert);
+//
+// Serialize() and Deserialize() save and restore the totals, e.g. with a
+// tN2kAlertStorage. Running intervals are not saved; they restart at the
+// next transition after a restore.
+class tN2kAlertStatistics {
+public:
+	tN2kAlertStatistics();
+
+	bool Attach(tN2kAlert &Alert);
+	void Reset();
+
+	// ms, including the time since the last transition for the current state
+	uint64_t GetTimeInState(tN2kAlertState AlertState) const;
+	uint32_t GetOccurenceCount() const { return OccurenceCount; }
+	// ms, 0 until two occurences were seen
+	uint32_t GetMeanTimeBetweenOccurences() const;
+
+	uint32_t GetResponseCount() const { return ResponseCount; }
+	// ms
+	uint32_t GetMeanResponseLatency() const;
+	uint16_t GetResponseLatencyCount(uint8_t Bucket) const;
+
+	size_t Serialize(uint8_t* Buffer, size_t Size) const;
+	bool Deserialize(const uint8_t* Buffer, size_t Size);
+
+private:
+	uint64_t StateTime[N2kAlertStatisticsStates];
+	uint32_t OccurenceCount;
+	uint64_t IntervalSum;
+	uint32_t IntervalCount;
+	uint32_t ResponseCount;
+	uint64_t ResponseSum;
+	uint16_t ResponseHistogram[N2kAlertStatisticsBuckets];
+
+	// Running intervals
+	tN2kAlertState CurrentState;
+	uint64_t StateSince;
+	uint64_t OccurenceStart;	// 0 if no occurence was seen since start
+	bool AwaitingResponse;
+
+	void Transition(const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus);
+	static void OnTransition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus, void* Context);
+};
+
+#endif
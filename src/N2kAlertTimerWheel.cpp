@@ -0,0 +1,86 @@
+//
+//
+//
+
+#include "N2kAlertTimerWheel.h"
+
+tN2kAlertTimerWheel::tN2kAlertTimerWheel(uint16_t _SlotCount, uint16_t _TickTime) :
+	TickTime(_TickTime > 0 ? _TickTime : 1) {
+
+	uint16_t SlotCount = 1;
+	while ((SlotCount < _SlotCount) && (SlotCount < 0x8000)) SlotCount <<= 1;
+	SlotMask = SlotCount - 1;
+	Slots = new tN2kAlertTimer[SlotCount];
+	for (uint16_t i = 0; i < SlotCount; i++) {
+		Slots[i].Next = &Slots[i];
+		Slots[i].Prev = &Slots[i];
+	}
+	CurrentTick = GetTick();
+}
+
+tN2kAlertTimerWheel::~tN2kAlertTimerWheel() {
+	for (uint16_t i = 0; i <= SlotMask; i++) {
+		while (Slots[i].Next != &Slots[i]) Cancel(*Slots[i].Next);
+	}
+	delete[] Slots;
+}
+
+void tN2kAlertTimerWheel::Start(tN2kAlertTimer &Timer, uint32_t Delay) {
+	uint32_t Ticks = (Delay + TickTime - 1) / TickTime;
+
+	Cancel(Timer);
+	Timer.Expires = GetTick() + (Ticks > 0 ? Ticks : 1);
+
+	tN2kAlertTimer* Head = &Slots[Timer.Expires & SlotMask];
+	Timer.Next = Head;
+	Timer.Prev = Head->Prev;
+	Head->Prev->Next = &Timer;
+	Head->Prev = &Timer;
+}
+
+void tN2kAlertTimerWheel::Cancel(tN2kAlertTimer &Timer) {
+	if (!Timer.IsActive()) return;
+	Timer.Prev->Next = Timer.Next;
+	Timer.Next->Prev = Timer.Prev;
+	Timer.Next = 0;
+	Timer.Prev = 0;
+}
+
+// Visits the slots of the passed ticks, each slot at most once per call.
+// The expired timers of a slot are first moved to a local list, so callbacks
+// can cancel or restart any timer: a timer taken off the list that way does
+// not fire.
+void tN2kAlertTimerWheel::Handle() {
+	uint32_t Now = GetTick();
+	uint32_t Steps = Now - CurrentTick;
+	tN2kAlertTimer Expired;
+
+	if (Steps == 0) return;
+	if (Steps > (uint32_t)SlotMask + 1) Steps = (uint32_t)SlotMask + 1;
+
+	for (uint32_t i = 1; i <= Steps; i++) {
+		tN2kAlertTimer* Head = &Slots[(CurrentTick + i) & SlotMask];
+		tN2kAlertTimer* Timer = Head->Next;
+
+		Expired.Next = &Expired;
+		Expired.Prev = &Expired;
+		while (Timer != Head) {
+			tN2kAlertTimer* Next = Timer->Next;
+			if ((int32_t)(Timer->Expires - Now) <= 0) {
+				Cancel(*Timer);
+				Timer->Next = &Expired;
+				Timer->Prev = Expired.Prev;
+				Expired.Prev->Next = Timer;
+				Expired.Prev = Timer;
+			}
+			Timer = Next;
+		}
+
+		while (Expired.Next != &Expired) {
+			Timer = Expired.Next;
+			Cancel(*Timer);
+			if (Timer->Callback != 0) Timer->Callback(*Timer, Timer->Context);
+		}
+	}
+	CurrentTick = Now;
+}
@@ -0,0 +1,70 @@
+// N2kAlertTimerWheel.h
+
+#ifndef _N2KALERTTIMERWHEEL_h
+#define _N2KALERTTIMERWHEEL_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include <N2kTimer.h>
+
+// Timer node for tN2kAlertTimerWheel. The node is embedded in the object
+// that owns the timer, so starting and cancelling a timer never allocates.
+class tN2kAlertTimer {
+public:
+	typedef void (*tCallback)(tN2kAlertTimer &Timer, void* Context);
+
+	tN2kAlertTimer(tCallback _Callback = 0, void* _Context = 0) :
+		Callback(_Callback), Context(_Context), Next(0), Prev(0), Expires(0) {}
+
+	void SetCallback(tCallback _Callback, void* _Context) { Callback = _Callback; Context = _Context; }
+	bool IsActive() const { return Next != 0; }
+
+private:
+	friend class tN2kAlertTimerWheel;
+
+	tCallback Callback;
+	void* Context;
+	tN2kAlertTimer* Next;
+	tN2kAlertTimer* Prev;
+	uint32_t Expires;		// Tick
+};
+
+// Hashed timing wheel shared by all alert timers.
+//
+// Time is counted in ticks of TickTime ms. A timer is kept in the slot of its
+// expiry tick, so Start() and Cancel() are O(1), and Handle() only visits the
+// slots of the ticks that passed since the last call. Timers longer than one
+// revolution (SlotCount ticks) stay in their slot until their tick comes.
+// Timers fire from Handle(), so callbacks run in the task that calls it.
+//
+//   tN2kAlertTimerWheel AlertTimers(64, 10);  // 64 slots of 10 ms
+//   loop(): AlertTimers.Handle();
+class tN2kAlertTimerWheel {
+public:
+	// SlotCount is rounded up to a power of two
+	tN2kAlertTimerWheel(uint16_t _SlotCount = 64, uint16_t _TickTime = 10);
+	~tN2kAlertTimerWheel();
+
+	tN2kAlertTimerWheel(const tN2kAlertTimerWheel&) = delete;
+	tN2kAlertTimerWheel &operator=(const tN2kAlertTimerWheel&) = delete;
+
+	// Restarts an active timer
+	void Start(tN2kAlertTimer &Timer, uint32_t Delay);
+	void Cancel(tN2kAlertTimer &Timer);
+
+	void Handle();
+
+private:
+	tN2kAlertTimer* Slots;		// List heads
+	uint16_t SlotMask;
+	uint16_t TickTime;
+	uint32_t CurrentTick;		// Last tick handled
+
+	uint32_t GetTick() const { return (uint32_t)(N2kMillis64() / TickTime); }
+};
+
+#endif
@@ -0,0 +1,215 @@
+//
+//
+//
+
+#include "N2kAlertTransmitter.h"
+
+#define N2kAlertTransmitPendingNotification 0x01
+#define N2kAlertTransmitPendingText 0x02
+#define N2kAlertTransmitDeferredText 0x04
+
+tN2kAlertTransmitter::tN2kAlertTransmitter(tNMEA2000 &_NMEA2000, tN2kAlert** _Alerts, uint16_t _AlertCount, int _DeviceIndex) :
+	NMEA2000(_NMEA2000),
+	Alerts(_Alerts),
+	AlertCount(_AlertCount),
+	DeviceIndex(_DeviceIndex),
+	NotificationPeriod(1000),
+	TextPeriod(10000),
+	NotificationCursor(0),
+	TextCursor(0),
+	StormActivations(5),
+	StormWindow(1000),
+	StormBudget(2),
+	StormInterval(100),
+	Activations(0),
+	Storm(false) {
+
+	Pending = new uint8_t[AlertCount > 0 ? AlertCount : 1];
+	for (uint16_t i = 0; i < AlertCount; i++) Pending[i] = 0;
+}
+
+tN2kAlertTransmitter::~tN2kAlertTransmitter() {
+	for (uint16_t i = 0; i < AlertCount; i++) Alerts[i]->DetachTransitionHandler(OnTransition, this);
+	delete[] Pending;
+}
+
+bool tN2kAlertTransmitter::Attach() {
+	bool Result = true;
+
+	for (uint16_t i = 0; i < AlertCount; i++) {
+		Result &= Alerts[i]->AttachTransitionHandler(OnTransition, this);
+		Pending[i] = N2kAlertTransmitPendingNotification | N2kAlertTransmitPendingText;
+	}
+	SetPeriods(NotificationPeriod, TextPeriod);
+	WindowTimer.FromNow(StormWindow);
+	return Result;
+}
+
+// Every alert is refreshed once per period
+void tN2kAlertTransmitter::SetPeriods(uint32_t _NotificationPeriod, uint32_t _TextPeriod) {
+	NotificationPeriod = _NotificationPeriod;
+	TextPeriod = _TextPeriod;
+	NotificationTimer.FromNow(AlertCount > 0 ? NotificationPeriod / AlertCount : NotificationPeriod);
+	TextTimer.FromNow(AlertCount > 0 ? TextPeriod / AlertCount : TextPeriod);
+}
+
+void tN2kAlertTransmitter::SetStormLimits(uint16_t _StormActivations, uint32_t _StormWindow, uint8_t _StormBudget, uint32_t _StormInterval) {
+	StormActivations = (_StormActivations > 0) ? _StormActivations : 1;
+	StormWindow = _StormWindow;
+	StormBudget = (_StormBudget > 0) ? _StormBudget : 1;
+	StormInterval = _StormInterval;
+	WindowTimer.FromNow(StormWindow);
+}
+
+uint16_t tN2kAlertTransmitter::GetPendingCount() const {
+	uint16_t Count = 0;
+
+	for (uint16_t i = 0; i < AlertCount; i++) {
+		if (Pending[i] & N2kAlertTransmitPendingNotification) Count++;
+	}
+	return Count;
+}
+
+bool tN2kAlertTransmitter::Resend(tN2kAlert &Alert) {
+	uint16_t i;
+
+	for (i = 0; (i < AlertCount) && (Alerts[i] != &Alert); i++);
+	if (i == AlertCount) return false;
+
+	Pending[i] |= N2kAlertTransmitPendingNotification;
+	return true;
+}
+
+void tN2kAlertTransmitter::OnTransition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus, void* Context) {
+	((tN2kAlertTransmitter*)Context)->Transition(Alert, OldStatus, NewStatus);
+}
+
+// A new occurence or escalation level also changes the key of the alert
+// text, so the text is sent again
+void tN2kAlertTransmitter::Transition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus) {
+	uint16_t i;
+
+	for (i = 0; (i < AlertCount) && (Alerts[i] != &Alert); i++);
+	if (i == AlertCount) return;
+
+	Pending[i] |= N2kAlertTransmitPendingNotification;
+	if (NewStatus.Occurence != OldStatus.Occurence) {
+		Pending[i] |= N2kAlertTransmitPendingText;
+		if (Activations < 0xffff) Activations++;
+		if (!Storm && (Activations >= StormActivations)) {
+			Storm = true;
+			StormTimer.FromNow(0);
+		}
+	}
+	if (NewStatus.EscalationLevel != OldStatus.EscalationLevel) Pending[i] |= N2kAlertTransmitPendingText;
+	if (Storm) DeferTexts();
+}
+
+// Texts requested during a storm are sent after it, one per text refresh
+// step, see Handle()
+void tN2kAlertTransmitter::DeferTexts() {
+	for (uint16_t i = 0; i < AlertCount; i++) {
+		if (Pending[i] & N2kAlertTransmitPendingText) {
+			Pending[i] = (Pending[i] & ~N2kAlertTransmitPendingText) | N2kAlertTransmitDeferredText;
+		}
+	}
+}
+
+int tN2kAlertTransmitter::FindNextDeferredText() const {
+	for (uint16_t n = 0; n < AlertCount; n++) {
+		uint16_t i = (TextCursor + n) % AlertCount;
+		if (Pending[i] & N2kAlertTransmitDeferredText) return i;
+	}
+	return -1;
+}
+
+void tN2kAlertTransmitter::UpdateStorm() {
+	if (!WindowTimer.IsTime()) return;
+	WindowTimer.FromNow(StormWindow);
+
+	if (Storm && (Activations < (StormActivations + 1) / 2) && (GetPendingCount() == 0)) {
+		Storm = false;
+	}
+	Activations = 0;
+}
+
+void tN2kAlertTransmitter::Send(uint16_t Index, uint8_t Flag) {
+	tN2kMsg N2kMsg;
+	tN2kAlertType RetiredType;
+
+	if (Flag == N2kAlertTransmitPendingNotification) {
+		// Displays drop the alert under its old type before they get the new one
+		while (Alerts[Index]->SetN2kAlertRetired(N2kMsg, RetiredType)) {
+			if (!NMEA2000.SendMsg(N2kMsg, DeviceIndex)) return;
+			Alerts[Index]->ClearRetired(RetiredType);
+			N2kMsg.Clear();
+		}
+		Alerts[Index]->SetN2kAlert(N2kMsg);
+	}
+	else {
+		Alerts[Index]->SetN2kAlertText(N2kMsg);
+	}
+	// A message that did not fit the send buffer stays pending. A sent text
+	// also replaces a deferred one.
+	if (NMEA2000.SendMsg(N2kMsg, DeviceIndex)) {
+		Pending[Index] &= ~Flag;
+		if (Flag == N2kAlertTransmitPendingText) Pending[Index] &= ~N2kAlertTransmitDeferredText;
+	}
+}
+
+// Pending notification of the most severe alert type, then the highest alert
+// priority (lowest value)
+int tN2kAlertTransmitter::FindNextStormSend() const {
+	int Best = -1;
+
+	for (uint16_t i = 0; i < AlertCount; i++) {
+		if ((Pending[i] & N2kAlertTransmitPendingNotification) == 0) continue;
+		if ((Best < 0) || (Alerts[i]->GetAlertType() < Alerts[Best]->GetAlertType()) ||
+			((Alerts[i]->GetAlertType() == Alerts[Best]->GetAlertType()) && (Alerts[i]->GetAlertPriority() < Alerts[Best]->GetAlertPriority()))) {
+			Best = i;
+		}
+	}
+	return Best;
+}
+
+void tN2kAlertTransmitter::Handle() {
+	if (AlertCount == 0) return;
+	UpdateStorm();
+
+	if (Storm) {
+		if (!StormTimer.IsTime()) return;
+		StormTimer.FromNow(StormInterval);
+		for (uint8_t i = 0; i < StormBudget; i++) {
+			int Index = FindNextStormSend();
+			if (Index < 0) break;
+			Send(Index, N2kAlertTransmitPendingNotification);
+			if (Pending[Index] & N2kAlertTransmitPendingNotification) break;	// Send buffer full
+		}
+		return;
+	}
+
+	if (NotificationTimer.IsTime()) {
+		NotificationTimer.FromNow(NotificationPeriod / AlertCount);
+		Pending[NotificationCursor] |= N2kAlertTransmitPendingNotification;
+		NotificationCursor = (NotificationCursor + 1) % AlertCount;
+	}
+	// A text deferred by a storm takes the place of the refresh, so the texts
+	// are drained at the refresh pace instead of in one burst
+	if (TextTimer.IsTime()) {
+		TextTimer.FromNow(TextPeriod / AlertCount);
+		int Index = FindNextDeferredText();
+		if (Index >= 0) {
+			Pending[Index] = (Pending[Index] & ~N2kAlertTransmitDeferredText) | N2kAlertTransmitPendingText;
+			TextCursor = (Index + 1) % AlertCount;
+		}
+		else {
+			Pending[TextCursor] |= N2kAlertTransmitPendingText;
+			TextCursor = (TextCursor + 1) % AlertCount;
+		}
+	}
+
+	for (uint16_t i = 0; i < AlertCount; i++) {
+		if (Pending[i] & N2kAlertTransmitPendingNotification) Send(i, N2kAlertTransmitPendingNotification);
+		if (Pending[i] & N2kAlertTransmitPendingText) Send(i, N2kAlertTransmitPendingText);
+	}
+}
@@ -0,0 +1,94 @@
+// N2kAlertTransmitter.h
+
+#ifndef _N2KALERTTRANSMITTER_h
+#define _N2KALERTTRANSMITTER_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include <NMEA2000.h>
+#include "N2kAlerts.h"
+
+// Sends 126983 and 126985 for a list of alerts.
+//
+// A changed alert is sent at the next Handle(), and all alerts are refreshed
+// one by one, spread evenly over the notification and text periods. When an
+// escalation changed the alert type, the alert under its old type is first
+// reported back to normal, see tN2kAlert::SetN2kAlertRetired().
+//
+// When StormActivations or more alerts start a new occurence within one
+// storm window, e.g. after a main breaker trips, the transmitter switches to
+// storm mode:
+//  - periodic refreshes stop, only changed alerts are sent
+//  - several changes of one alert are coalesced into one message with the
+//    latest state
+//  - 126985 texts are deferred until the storm is over and then sent one per
+//    text refresh step (TextPeriod / AlertCount)
+//  - at most StormBudget notifications are sent per storm interval, the most
+//    severe alert type and highest priority first
+// The transmitter leaves storm mode after a window with less than half the
+// activations and no backlog.
+//
+//   tN2kAlert* Alerts[] = { &TemperatureAlert, &PressureAlert };
+//   tN2kAlertTransmitter AlertTransmitter(NMEA2000, Alerts, 2, AlarmDevice);
+//
+//   setup(): AlertTransmitter.Attach();
+//   loop():  AlertTransmitter.Handle();
+class tN2kAlertTransmitter {
+public:
+	tN2kAlertTransmitter(tNMEA2000 &_NMEA2000, tN2kAlert** _Alerts, uint16_t _AlertCount, int _DeviceIndex = 0);
+	~tN2kAlertTransmitter();
+
+	tN2kAlertTransmitter(const tN2kAlertTransmitter&) = delete;
+	tN2kAlertTransmitter &operator=(const tN2kAlertTransmitter&) = delete;
+
+	bool Attach();
+
+	void SetPeriods(uint32_t _NotificationPeriod, uint32_t _TextPeriod);
+	void SetStormLimits(uint16_t _StormActivations, uint32_t _StormWindow, uint8_t _StormBudget, uint32_t _StormInterval);
+
+	// Sends the notification of the alert again with the next Handle().
+	// Returns false if the alert is not in the list.
+	bool Resend(tN2kAlert &Alert);
+
+	bool IsStorm() const { return Storm; }
+	uint16_t GetPendingCount() const;
+
+	void Handle();
+
+private:
+	tNMEA2000 &NMEA2000;
+	tN2kAlert** Alerts;
+	uint16_t AlertCount;
+	int DeviceIndex;
+	uint8_t* Pending;			// N2kAlertTransmitPending... per alert
+
+	uint32_t NotificationPeriod;
+	uint32_t TextPeriod;
+	tN2kScheduler NotificationTimer;
+	tN2kScheduler TextTimer;
+	uint16_t NotificationCursor;
+	uint16_t TextCursor;
+
+	uint16_t StormActivations;
+	uint32_t StormWindow;
+	uint8_t StormBudget;
+	uint32_t StormInterval;
+	tN2kScheduler WindowTimer;
+	tN2kScheduler StormTimer;
+	uint16_t Activations;
+	bool Storm;
+
+	void Send(uint16_t Index, uint8_t Flag);
+	int FindNextStormSend() const;
+	int FindNextDeferredText() const;
+	void DeferTexts();
+	void UpdateStorm();
+	void Transition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus);
+	static void OnTransition(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus, void* Context);
+};
+
+#endif
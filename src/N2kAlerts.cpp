@@ -4,40 +4,138 @@
 
 #include "N2kAlerts.h"
 #include "N2kAlertMessagesEnumToStr.h"
+#include "N2kAlertAtomic.h"
+#include "N2kAlertResponseFilter.h"
+
+// Layout of tN2kAlert::Status
+#define N2kAlertStatusStateMask 0x0000000fUL
+#define N2kAlertStatusThresholdShift 4
+#define N2kAlertStatusThresholdMask 0x000000f0UL
+#define N2kAlertStatusSilenced 0x00000100UL
+#define N2kAlertStatusAcknowledged 0x00000200UL
+#define N2kAlertStatusEscalated 0x00000400UL
+#define N2kAlertStatusInhibited 0x00000800UL
+#define N2kAlertStatusEscalationShift 12
+#define N2kAlertStatusEscalationMask 0x0000f000UL
+#define N2kAlertStatusOccurenceShift 16
+#define N2kAlertStatusOccurenceMask 0x00ff0000UL
+// Bits that make a transition when they change
+#define N2kAlertStatusTransitionMask (N2kAlertStatusStateMask | N2kAlertStatusThresholdMask | N2kAlertStatusSilenced | N2kAlertStatusAcknowledged | N2kAlertStatusEscalated | N2kAlertStatusEscalationMask)
+
+static inline tN2kAlertState StatusAlertState(uint32_t _Status) {
+	return tN2kAlertState(_Status & N2kAlertStatusStateMask);
+}
+
+static inline uint32_t SetStatusAlertState(uint32_t _Status, tN2kAlertState AlertState) {
+	return (_Status & ~N2kAlertStatusStateMask) | ((uint32_t)AlertState & N2kAlertStatusStateMask);
+}
+
+static inline tN2kAlertThresholdStatus StatusThreshold(uint32_t _Status) {
+	return tN2kAlertThresholdStatus((_Status & N2kAlertStatusThresholdMask) >> N2kAlertStatusThresholdShift);
+}
+
+static inline uint32_t SetStatusThreshold(uint32_t _Status, tN2kAlertThresholdStatus ThresholdStatus) {
+	return (_Status & ~N2kAlertStatusThresholdMask) | (((uint32_t)ThresholdStatus << N2kAlertStatusThresholdShift) & N2kAlertStatusThresholdMask);
+}
+
+static inline uint8_t StatusOccurence(uint32_t _Status) {
+	return (_Status & N2kAlertStatusOccurenceMask) >> N2kAlertStatusOccurenceShift;
+}
+
+static inline uint32_t SetStatusOccurence(uint32_t _Status, uint8_t Occurence) {
+	return (_Status & ~N2kAlertStatusOccurenceMask) | ((uint32_t)Occurence << N2kAlertStatusOccurenceShift);
+}
+
+static inline uint8_t StatusEscalationLevel(uint32_t _Status) {
+	return (_Status & N2kAlertStatusEscalationMask) >> N2kAlertStatusEscalationShift;
+}
+
+static inline tN2kAlertYesNo StatusFlag(uint32_t _Status, uint32_t Flag) {
+	return (_Status & Flag) ? N2kts_AlertYes : N2kts_AlertNo;
+}
+
+static inline uint32_t SetStatusFlag(uint32_t _Status, uint32_t Flag, bool Set) {
+	return Set ? (_Status | Flag) : (_Status & ~Flag);
+}
 
 
 
 tN2kAlert::tN2kAlert(tN2kAlertType _AlertType, tN2kAlertCategory _AlertCategory, uint16_t _AlertId, tN2kAlertTriggerCondition _TriggerCondition, uint8_t _AlertPriority,
 	tN2kAlertYesNo _TemporarySilenceSupport, tN2kAlertYesNo _AcknowledgeSupport, tN2kAlertYesNo _EscalationSupport) :
-	AlertType(_AlertType),
-	AlertCategory(_AlertCategory),
 	AlertId(_AlertId),
 	AlertPriority(_AlertPriority),
+	AlertType(_AlertType),
+	BaseAlertType(_AlertType),
+	AlertCategory(_AlertCategory),
+	Status(N2kts_AlertStateNormal),
+	AlertLanguage(N2kts_AlertLanguageEnglishUS),
+	AlertDescription(""),
+	AlertLocation(""),
+	TextBuffer(0),
+	AlertSystem(0),
+	AlertSubSystem(0),
+	AcknowledgeNetworkId(0),
+	DataSourceNetworkId(0),
+	DataSourceInstance(0),
+	DataSourceIndexSource(0),
 	TemporarySilenceSupport(_TemporarySilenceSupport),
 	AcknowledgeSupport(_AcknowledgeSupport),
 	EscalationSupport(_EscalationSupport),
-	TemporarySilenceStatus(N2kts_AlertNo),
-	AcknowledgeStatus(N2kts_AlertNo),
-	EscalationStatus(N2kts_AlertNo),
-	Occurence(0),
-	TriggerCondition(_TriggerCondition) {
+	TriggerCondition(_TriggerCondition),
+	ThresholdMethod(N2kts_AlertThresholdMethodEqual),
+	ThresholdFormat(0),
+	ThresholdLevel(0),
+	LastValue(0),
+	ResponseFilter(0),
+	RetiredTypes(0),
+	Dispatching(false) {
 
-	ThresholdStatus = N2kts_AlertThresholdStatusNormal;
 	SetTemporarySilenceTime(3600);
 	TemporarySilenceTimer = tN2kScheduler(TemporarySilenceDelay);
+	UpdateAlertUID();
+	for (uint8_t i = 0; i < N2kAlertMaxTransitionHandlers; i++) {
+		TransitionSlots[i].Handler = 0;
+		TransitionSlots[i].Context = 0;
+	}
 
 };
 
+tN2kAlert::~tN2kAlert() {
+	delete[] TextBuffer;
+}
+
+tN2kAlert::tN2kAlert(const tN2kAlertDefinition &Definition) :
+	tN2kAlert(Definition.AlertType, Definition.AlertCategory, Definition.AlertId, Definition.TriggerCondition, Definition.AlertPriority,
+		(Definition.Support & N2kAlertSupportTemporarySilence) ? N2kts_AlertYes : N2kts_AlertNo,
+		(Definition.Support & N2kAlertSupportAcknowledge) ? N2kts_AlertYes : N2kts_AlertNo,
+		(Definition.Support & N2kAlertSupportEscalation) ? N2kts_AlertYes : N2kts_AlertNo) {
+
+	SetAlertSystemStatic(Definition.AlertSystem, Definition.AlertSubSystem, 0, Definition.AlertLanguage, Definition.AlertDescription, Definition.AlertLocation);
+	SetAlertThreshold(Definition.ThresholdMethod, Definition.ThresholdFormat, Definition.ThresholdLevel);
+}
+
 // AlertSystem				: UID in the Network for this device
 // AlertSubsystem			: ID for each alert on this device
 // AcknowledgeNetworkId		; Network ID for this alert device
-void tN2kAlert::SetAlertSystem(uint8_t _Alertsystem, uint8_t _AlertSubsystem, uint64_t _AcknowledgeNetworkId, tN2kAlertLanguage _AlertLanguage, char* _AlertDescription, char* _AlertLocation) {
+void tN2kAlert::SetAlertSystem(uint8_t _Alertsystem, uint8_t _AlertSubsystem, uint64_t _AcknowledgeNetworkId, tN2kAlertLanguage _AlertLanguage, const char* _AlertDescription, const char* _AlertLocation) {
+	if (TextBuffer == 0) TextBuffer = new char[2 * (String_Len + 1)];
+	strlcpy(TextBuffer, _AlertDescription, String_Len + 1);
+	strlcpy(TextBuffer + String_Len + 1, _AlertLocation, String_Len + 1);
+	SetAlertSystemStatic(_Alertsystem, _AlertSubsystem, _AcknowledgeNetworkId, _AlertLanguage, TextBuffer, TextBuffer + String_Len + 1);
+}
+
+void tN2kAlert::SetAlertSystemStatic(uint8_t _Alertsystem, uint8_t _AlertSubsystem, uint64_t _AcknowledgeNetworkId, tN2kAlertLanguage _AlertLanguage, const char* _AlertDescription, const char* _AlertLocation) {
 	AlertSystem = _Alertsystem;
 	AlertSubSystem = _AlertSubsystem;
 	AcknowledgeNetworkId = _AcknowledgeNetworkId;
 	AlertLanguage = _AlertLanguage;
-	strlcpy(AlertDescription, _AlertDescription, String_Len);
-	strlcpy(AlertLocation, _AlertLocation, String_Len);
+	AlertDescription = _AlertDescription;
+	AlertLocation = _AlertLocation;
+	UpdateAlertUID();
+}
+
+void tN2kAlert::SetAcknowledgeNetworkId(uint64_t _AcknowledgeNetworkId) {
+	AcknowledgeNetworkId = _AcknowledgeNetworkId;
 }
 
 // This settings are need for linking the alert and senosr together
@@ -48,6 +146,7 @@ void tN2kAlert::SetAlertDataSource(uint8_t _DataSourceInstance, uint8_t _Datesou
 	DataSourceNetworkId = _DataSourceNetworkId;
 	DataSourceInstance = _DataSourceInstance;
 	DataSourceIndexSource = _DatesourceIndexSource;
+	UpdateAlertUID();
 }
 
 void tN2kAlert::SetAlertThreshold(t2kNAlertThresholdMethod _Method, uint8_t _Format, uint64_t _Level){
@@ -68,12 +167,24 @@ tN2kAlertCategory tN2kAlert::GetAlertCategory(){
 	return tN2kAlertCategory(AlertCategory);
 }
 
+uint8_t tN2kAlert::GetAlertPriority(){
+	return AlertPriority;
+}
+
+t2kNAlertThresholdMethod tN2kAlert::GetAlertThresholdMethod(){
+	return ThresholdMethod;
+}
+
+uint64_t tN2kAlert::GetAlertThresholdLevel(){
+	return ThresholdLevel;
+}
+
 tN2kAlertThresholdStatus tN2kAlert::GetAlertThresholdStatus(){
-	return tN2kAlertThresholdStatus(ThresholdStatus);
+	return StatusThreshold(LoadStatus());
 }
 
 tN2kAlertState tN2kAlert::GetAlertState(){
-	return tN2kAlertState(AlertState);
+	return StatusAlertState(LoadStatus());
 }
 
 tN2kAlertYesNo tN2kAlert::GetTemporarySilenceSupport(){
@@ -89,103 +200,210 @@ tN2kAlertYesNo tN2kAlert::GetEscalationSupport(){
 }
 
 tN2kAlertYesNo tN2kAlert::GetTemporarySilenceStatus(){
-	return tN2kAlertYesNo(TemporarySilenceStatus);
+	return StatusFlag(LoadStatus(), N2kAlertStatusSilenced);
 }
 
 tN2kAlertYesNo tN2kAlert::GetAcknowledgeStatus(){
-	return tN2kAlertYesNo(AcknowledgeStatus);
+	return StatusFlag(LoadStatus(), N2kAlertStatusAcknowledged);
 }
 
 tN2kAlertYesNo tN2kAlert::GetEscalationStatus(){
-	return tN2kAlertYesNo(EscalationStatus);
+	return StatusFlag(LoadStatus(), N2kAlertStatusEscalated);
+}
+
+static void UnpackStatus(uint32_t _Status, tN2kAlertStatus &AlertStatus) {
+	AlertStatus.AlertState = StatusAlertState(_Status);
+	AlertStatus.ThresholdStatus = StatusThreshold(_Status);
+	AlertStatus.TemporarySilenceStatus = StatusFlag(_Status, N2kAlertStatusSilenced);
+	AlertStatus.AcknowledgeStatus = StatusFlag(_Status, N2kAlertStatusAcknowledged);
+	AlertStatus.EscalationStatus = StatusFlag(_Status, N2kAlertStatusEscalated);
+	AlertStatus.EscalationLevel = StatusEscalationLevel(_Status);
+	AlertStatus.Occurence = StatusOccurence(_Status);
+}
+
+void tN2kAlert::GetAlertStatus(tN2kAlertStatus &AlertStatus) const{
+	UnpackStatus(LoadStatus(), AlertStatus);
+}
+
+// Returns false when all slots are in use
+bool tN2kAlert::AttachTransitionHandler(tN2kAlertTransitionHandler Handler, void* Context){
+	for (uint8_t i = 0; i < N2kAlertMaxTransitionHandlers; i++) {
+		if (TransitionSlots[i].Handler == 0) {
+			TransitionSlots[i].Context = Context;
+			TransitionSlots[i].Handler = Handler;
+			return true;
+		}
+	}
+	return false;
+}
+
+void tN2kAlert::DetachTransitionHandler(tN2kAlertTransitionHandler Handler, void* Context){
+	for (uint8_t i = 0; i < N2kAlertMaxTransitionHandlers; i++) {
+		if ((TransitionSlots[i].Handler == Handler) && (TransitionSlots[i].Context == Context)) {
+			TransitionSlots[i].Handler = 0;
+			TransitionSlots[i].Context = 0;
+		}
+	}
 }
 
-void tN2kAlert::SetAlertExceeded() {
+uint32_t tN2kAlert::LoadStatus() const{
+	return N2kAlertAtomicLoad(Status);
+}
+
+// All changes of the status are made on a local copy and published here with
+// one atomic store, so readers never see a partly updated status.
+void tN2kAlert::StoreStatus(uint32_t _Status){
+	uint32_t OldStatus = Status;
+	tN2kAlertStatus Old;
+	tN2kAlertStatus New;
+
+	N2kAlertAtomicStore(Status, _Status);
+	// A change made by a handler is reported by the running loop below after
+	// all handlers got the current one, so every handler sees the changes in
+	// order and ends on the final status
+	if (Dispatching) return;
+
+	Dispatching = true;
+	while (((OldStatus ^ _Status) & N2kAlertStatusTransitionMask) != 0) {
+		UnpackStatus(OldStatus, Old);
+		UnpackStatus(_Status, New);
+		for (uint8_t i = 0; i < N2kAlertMaxTransitionHandlers; i++) {
+			if (TransitionSlots[i].Handler != 0) {
+				TransitionSlots[i].Handler(*this, Old, New, TransitionSlots[i].Context);
+			}
+		}
+		OldStatus = _Status;
+		_Status = Status;
+	}
+	Dispatching = false;
+}
+
+uint32_t tN2kAlert::SetAlertExceeded(uint32_t _Status) {
+	uint8_t Occurence = StatusOccurence(_Status);
 
 	if (Occurence > 250) Occurence = 0;
 
-	if (ThresholdStatus == N2kts_AlertThresholdStatusNormal) {
-		ThresholdStatus = N2kts_AlertThresholdStatusExceeded;
+	if (StatusThreshold(_Status) == N2kts_AlertThresholdStatusNormal) {
+		_Status = SetStatusThreshold(_Status, N2kts_AlertThresholdStatusExceeded);
 		Occurence++;
 	}
+	_Status = SetStatusOccurence(_Status, Occurence);
 
-	if (ThresholdStatus == N2kts_AlertThresholdStatusExceeded) {
-		AlertState = N2kts_AlertStateActive;
-		if (TemporarySilenceStatus == N2kts_AlertYes) {
-			AlertState == N2kts_AlertStateSilenced;
+	// An alert that must be acknowledged waits for it, see N2kAlertHandshake.h
+	if (StatusThreshold(_Status) == N2kts_AlertThresholdStatusExceeded) {
+		_Status = SetStatusAlertState(_Status, (AcknowledgeSupport == N2kts_AlertYes) ? N2kts_AlertStateAwaitingAcknowledge : N2kts_AlertStateActive);
+		if (_Status & N2kAlertStatusSilenced) {
+			_Status = SetStatusAlertState(_Status, N2kts_AlertStateSilenced);
 		}
 
-		if (AcknowledgeStatus == N2kts_AlertYes) {
-			AlertState == N2kts_AlertStateAcknowledged;
-			ThresholdStatus = N2kts_AlertThresholdStatusAcknowledged;
+		if (_Status & N2kAlertStatusAcknowledged) {
+			_Status = SetStatusAlertState(_Status, N2kts_AlertStateAcknowledged);
+			_Status = SetStatusThreshold(_Status, N2kts_AlertThresholdStatusAcknowledged);
 		}
 	}
+	return _Status;
 }
 
-void tN2kAlert::ResetAlert() {
+uint32_t tN2kAlert::ResetAlert(uint32_t _Status) {
 
-	ThresholdStatus = N2kts_AlertThresholdStatusNormal;
-	AlertState = N2kts_AlertStateNormal;
+	_Status = SetStatusThreshold(_Status, N2kts_AlertThresholdStatusNormal);
+	_Status = SetStatusAlertState(_Status, N2kts_AlertStateNormal);
 
-	AcknowledgeStatus = N2kts_AlertNo;
+	return SetStatusFlag(_Status, N2kAlertStatusAcknowledged, false);
 }
 
 tN2kAlertThresholdStatus tN2kAlert::TestAlertThreshold(uint64_t v){
+	bool Exceeded;
 
-	//Serial.print("Threshold level : "); Serial.println(ThresholdLevel);
-	//Serial.print("Value           : "); Serial.println(v);
-	//Serial.print("Method          : "); Serial.println(N2kEnumAlertTypeToStr(ThresholdMethod));
-	//Serial.print("Alert state     : "); Serial.println(N2kEnumAlertTypeToStr(AlertState));
-	//Serial.print("Threshold status: "); Serial.println(N2kEnumAlertTypeToStr(ThresholdStatus));
-	//Serial.println("*******************************");
+	if (Status & N2kAlertStatusInhibited) return N2kts_AlertThresholdStatusNormal;
 
+	LastValue = v;
+	switch (ThresholdMethod) {
+		case N2kts_AlertThresholddMethodGreater:
+			Exceeded = v > ThresholdLevel;
+			break;
 
-	if (ThresholdMethod == N2kts_AlertThresholddMethodGreater) {
-		if (v > ThresholdLevel) {
-			SetAlertExceeded();
-		}
-		else {
-			ResetAlert();
-		}
-	}
+		case N2kts_AlertThresholdMethodLower:
+			Exceeded = v < ThresholdLevel;
+			break;
 
-	if (ThresholdMethod == N2kts_AlertThresholdMethodLower) {
-		if (v < ThresholdLevel) {
-			SetAlertExceeded();
-		}
-		else {
-			ResetAlert();
-		}
+		default:
+			Exceeded = v == ThresholdLevel;
+			break;
 	}
 
-	if (ThresholdMethod == N2kts_AlertThresholdMethodEqual) {
-		if (v == ThresholdLevel) {
-			SetAlertExceeded();
-		}
-		else {
-			ResetAlert();
-		}
-	}
+	return UpdateAlert(Exceeded);
+}
+
+// For alerts from a condition instead of a value, e.g. a status bit
+tN2kAlertThresholdStatus tN2kAlert::TestAlertCondition(bool Active){
+	if (Status & N2kAlertStatusInhibited) return N2kts_AlertThresholdStatusNormal;
+
+	LastValue = Active ? 1 : 0;
+	return UpdateAlert(Active);
+}
+
+tN2kAlertThresholdStatus tN2kAlert::UpdateAlert(bool Exceeded){
+	uint32_t _Status = Status;
+
+	_Status = Exceeded ? SetAlertExceeded(_Status) : ResetAlert(_Status);
 
 	if (TemporarySilenceTimer.IsTime()) {
-		TemporarySilenceStatus = N2kts_AlertNo;
+		_Status = SetStatusFlag(_Status, N2kAlertStatusSilenced, false);
 	}
 
-	return tN2kAlertThresholdStatus(ThresholdStatus);
+	StoreStatus(_Status);
+	return StatusThreshold(_Status);
+}
+
+// The UID is precomputed so matching a received message against this alert
+// is a single key compare
+void tN2kAlert::UpdateAlertUID(){
+	UID = N2kAlertUID(AlertType, AlertCategory, AlertSystem, AlertSubSystem, AlertId, DataSourceNetworkId);
+}
+
+void tN2kAlert::GetAlertKey(tN2kAlertKey &Key){
+	Key.AlertType = AlertType;
+	Key.AlertCategory = AlertCategory;
+	Key.AlertSystem = AlertSystem;
+	Key.AlertSubSystem = AlertSubSystem;
+	Key.AlertID = AlertId;
+	Key.SourceNetworkID = DataSourceNetworkId;
+	Key.DataSourceInstance = DataSourceInstance;
+	Key.DataSourceIndex = DataSourceIndexSource;
+	Key.AlertOccurence = StatusOccurence(LoadStatus());
+	Key.UID = UID;
+}
+
+void tN2kAlert::GetAlertNotification(tN2kAlertNotification &AlertNotification){
+	uint32_t _Status = LoadStatus();
+
+	GetAlertKey(AlertNotification.Key);
+	AlertNotification.Key.AlertOccurence = StatusOccurence(_Status);
+	AlertNotification.AcknowledgeNetworkID = AcknowledgeNetworkId;
+	AlertNotification.TriggerCondition = TriggerCondition;
+	AlertNotification.ThresholdStatus = StatusThreshold(_Status);
+	AlertNotification.AlertPriority = AlertPriority;
+	AlertNotification.AlertState = StatusAlertState(_Status);
+	AlertNotification.TemporarySilenceStatus = StatusFlag(_Status, N2kAlertStatusSilenced);
+	AlertNotification.AcknowledgeStatus = StatusFlag(_Status, N2kAlertStatusAcknowledged);
+	AlertNotification.EscalationStatus = StatusFlag(_Status, N2kAlertStatusEscalated);
+	AlertNotification.TemporarySilenceSupport = TemporarySilenceSupport;
+	AlertNotification.AcknowledgeSupport = AcknowledgeSupport;
+	AlertNotification.EscalationSupport = EscalationSupport;
 }
 
 void tN2kAlert::SetN2kAlertText(tN2kMsg &N2kMsg){
 	SetN2kPGN126985(N2kMsg, AlertType, AlertCategory, AlertSystem, AlertSubSystem, AlertId, 
 		DataSourceNetworkId, DataSourceInstance, DataSourceIndexSource, 
-		Occurence, AlertLanguage, AlertDescription, AlertLocation);
+		StatusOccurence(LoadStatus()), AlertLanguage, AlertDescription, AlertLocation);
 }
 
 void tN2kAlert::SetN2kAlert(tN2kMsg &N2kMsg){
-	SetN2kPGN126983(N2kMsg, AlertType, AlertCategory, AlertSystem, AlertSubSystem, AlertId, 
-		DataSourceNetworkId, DataSourceInstance, DataSourceIndexSource, 
-		Occurence, AcknowledgeNetworkId, TriggerCondition, ThresholdStatus, AlertPriority, AlertState,
-		TemporarySilenceStatus, AcknowledgeStatus, EscalationStatus, 
-		TemporarySilenceSupport, AcknowledgeSupport, EscalationSupport);
+	tN2kAlertNotification AlertNotification;
+
+	GetAlertNotification(AlertNotification);
+	SetN2kPGN126983(N2kMsg, AlertNotification);
 }
 
 void tN2kAlert::SetTemporarySilenceTime(uint16_t seconds){
@@ -193,30 +411,24 @@ void tN2kAlert::SetTemporarySilenceTime(uint16_t seconds){
 }
 
 bool tN2kAlert::ParseAlertResponse(const tN2kMsg &N2kMsg){
-	tN2kAlertType _AlertType;
-	tN2kAlertCategory _AlertCategory;
-	unsigned char _AlertSystem;
-	unsigned char _AlertSubSystem;
-	unsigned int _AlertID;
-	uint64_t _SourceNetworkID;
-	unsigned char _DataSourceInstance;
-	unsigned char _DataSourceIndex;
-	unsigned char _AlertOccurence;
-	uint64_t _AcknowledgeNetworkID;
-	tN2kAlertResponseCommand _ResponseCommand;
-
-	if (ParseN2kAlertResponse(N2kMsg, _AlertType, _AlertCategory, _AlertSystem, _AlertSubSystem, _AlertID, 
-		_SourceNetworkID, _DataSourceInstance, _DataSourceIndex, _AlertOccurence, _AcknowledgeNetworkID, 
-		_ResponseCommand)) {
-		if ((AlertSystem == _AlertSystem) && (AlertSubSystem == _AlertSubSystem)) {
-			switch (_ResponseCommand) {
-				case N2kts_AlertResponseAcknowledge:
-					AcknowledgeStatus = N2kts_AlertYes;
+	tN2kAlertResponse AlertResponse;
+
+	if (ParseN2kAlertResponse(N2kMsg, AlertResponse)) {
+		if (AlertResponse.Key.UID == UID) {
+			if ((ResponseFilter != 0) && ResponseFilter->IsRepeat(AlertResponse)) return true;
+			switch (AlertResponse.ResponseCommand) {
+				case N2kts_AlertResponseAcknowledge: {
+					// An active alert goes to the acknowledged state at once,
+					// not with the next sample
+					uint32_t _Status = SetStatusFlag(Status, N2kAlertStatusAcknowledged, true);
+					if (StatusThreshold(_Status) != N2kts_AlertThresholdStatusNormal) _Status = SetAlertExceeded(_Status);
+					StoreStatus(_Status);
 					break;
+				}
 
 				case N2kts_AlertResponseTemporarySilence:
-					TemporarySilenceStatus = N2kts_AlertYes;
 					TemporarySilenceTimer.FromNow(TemporarySilenceDelay);
+					StoreStatus(SetStatusFlag(Status, N2kAlertStatusSilenced, true));
 					break;
 
 				case N2kts_AlertResponseTestCommandOff:
@@ -234,16 +446,123 @@ bool tN2kAlert::ParseAlertResponse(const tN2kMsg &N2kMsg){
 	return false;
 }
 bool tN2kAlert::isAlert(){
-	return ThresholdStatus != N2kts_AlertThresholdStatusNormal;
+	return StatusThreshold(LoadStatus()) != N2kts_AlertThresholdStatusNormal;
 }
 
 bool tN2kAlert::isAcknowledged(){
-	return AcknowledgeStatus = N2kts_AlertYes;
+	return (LoadStatus() & N2kAlertStatusAcknowledged) != 0;
 }
 
 bool tN2kAlert::isSilent(){
-	return TemporarySilenceStatus = N2kts_AlertYes;
+	return (LoadStatus() & N2kAlertStatusSilenced) != 0;
 }
-;
 
+// An inhibited alert is reset to normal and TestAlertThreshold() skips it
+// until the inhibition is removed. See N2kAlertInhibition.h
+void tN2kAlert::SetInhibited(bool Inhibited){
+	uint32_t _Status = Status;
+
+	if (Inhibited) {
+		_Status = ResetAlert(_Status) | N2kAlertStatusInhibited;
+	}
+	else {
+		_Status &= ~N2kAlertStatusInhibited;
+	}
+	StoreStatus(_Status);
+}
 
+// The new status is stored after the UID changed, so transition handlers
+// already see the new alert type
+void tN2kAlert::SetEscalation(uint8_t Level, tN2kAlertType _AlertType){
+	uint32_t _Status = Status;
+
+	if (Level > 15) Level = 15;
+	ChangeAlertType(_AlertType);
+	_Status = SetStatusFlag(_Status, N2kAlertStatusEscalated, Level > 0);
+	_Status = (_Status & ~N2kAlertStatusEscalationMask) | ((uint32_t)Level << N2kAlertStatusEscalationShift);
+	StoreStatus(_Status);
+}
+
+// Displays know the alert by its UID, so the identity of the old type is
+// retired and gets a last normal notification, see SetN2kAlertRetired()
+void tN2kAlert::ChangeAlertType(tN2kAlertType _AlertType){
+	if (_AlertType == AlertType) return;
+	RetiredTypes |= (uint16_t)1 << (AlertType & 0x0f);
+	RetiredTypes &= ~((uint16_t)1 << (_AlertType & 0x0f));
+	AlertType = _AlertType;
+	UpdateAlertUID();
+}
+
+// Builds the last 126983 for a retired alert type: the alert under that type
+// is reported back to normal. Returns false when no type is retired.
+bool tN2kAlert::SetN2kAlertRetired(tN2kMsg &N2kMsg, tN2kAlertType &RetiredType){
+	tN2kAlertNotification AlertNotification;
+	uint8_t Type;
+
+	if (RetiredTypes == 0) return false;
+	for (Type = 0; (RetiredTypes & ((uint16_t)1 << Type)) == 0; Type++);
+	RetiredType = tN2kAlertType(Type);
+
+	GetAlertNotification(AlertNotification);
+	AlertNotification.Key.AlertType = RetiredType;
+	AlertNotification.Key.UID = N2kAlertUID(RetiredType, AlertCategory, AlertSystem, AlertSubSystem, AlertId, DataSourceNetworkId);
+	AlertNotification.ThresholdStatus = N2kts_AlertThresholdStatusNormal;
+	AlertNotification.AlertState = N2kts_AlertStateNormal;
+	AlertNotification.TemporarySilenceStatus = N2kts_AlertNo;
+	AlertNotification.AcknowledgeStatus = N2kts_AlertNo;
+	AlertNotification.EscalationStatus = N2kts_AlertNo;
+	SetN2kPGN126983(N2kMsg, AlertNotification);
+	return true;
+}
+
+void tN2kAlert::ClearRetired(tN2kAlertType RetiredType){
+	RetiredTypes &= ~((uint16_t)1 << (RetiredType & 0x0f));
+}
+
+uint8_t tN2kAlert::GetEscalationLevel(){
+	return StatusEscalationLevel(LoadStatus());
+}
+
+bool tN2kAlert::isInhibited(){
+	return (LoadStatus() & N2kAlertStatusInhibited) != 0;
+}
+
+void tN2kAlert::GetSnapshot(tN2kAlertSnapshot &Snapshot){
+	uint32_t _Status = LoadStatus();
+
+	Snapshot.AlertId = AlertId;
+	Snapshot.Occurence = StatusOccurence(_Status);
+	Snapshot.State = StatusAlertState(_Status) | (StatusThreshold(_Status) << 4);
+	Snapshot.Flags = 0;
+	if (_Status & N2kAlertStatusAcknowledged) Snapshot.Flags |= N2kAlertSnapshotFlagAcknowledged;
+	if (_Status & N2kAlertStatusSilenced) Snapshot.Flags |= N2kAlertSnapshotFlagSilenced;
+	if (_Status & N2kAlertStatusEscalated) Snapshot.Flags |= N2kAlertSnapshotFlagEscalated;
+}
+
+// Restores the state saved before a reset. The threshold status is restored
+// too, so an alert that is still exceeded keeps its occurence number instead
+// of being reported as a new occurence. A restored silence runs for the full
+// silence time again.
+bool tN2kAlert::RestoreSnapshot(const tN2kAlertSnapshot &Snapshot){
+	uint32_t _Status = Status;
+
+	if (Snapshot.AlertId != AlertId) return false;
+	if ((Snapshot.State & 0x0f) > N2kts_AlertStateAwaitingAcknowledge) return false;
+	if ((Snapshot.State >> 4) > N2kts_AlertThresholdStatusAwaitingAcknowledge) return false;
+
+	_Status = SetStatusOccurence(_Status, Snapshot.Occurence);
+	_Status = SetStatusAlertState(_Status, tN2kAlertState(Snapshot.State & 0x0f));
+	_Status = SetStatusThreshold(_Status, tN2kAlertThresholdStatus(Snapshot.State >> 4));
+	_Status = SetStatusFlag(_Status, N2kAlertStatusAcknowledged, (Snapshot.Flags & N2kAlertSnapshotFlagAcknowledged) != 0);
+	// The escalation type is not in the snapshot, so the alert restarts
+	// unescalated and tN2kAlertEscalation escalates it again if needed
+	_Status = SetStatusFlag(_Status, N2kAlertStatusEscalated, false);
+	_Status &= ~N2kAlertStatusEscalationMask;
+	ChangeAlertType(BaseAlertType);
+	_Status = SetStatusFlag(_Status, N2kAlertStatusSilenced, (Snapshot.Flags & N2kAlertSnapshotFlagSilenced) != 0);
+	if (Snapshot.Flags & N2kAlertSnapshotFlagSilenced) {
+		TemporarySilenceTimer.FromNow(TemporarySilenceDelay);
+	}
+	StoreStatus(_Status);
+	return true;
+}
@@ -14,17 +14,151 @@
 
 #define String_Len 50
 
+//*****************************************************************************
+// Alert definitions
+//
+// Alerts can be declared as a constexpr table instead of being configured in
+// setup(). On ESP32, ARM and other targets with memory mapped flash the table
+// and its texts stay in flash; tN2kAlert only references the texts and keeps
+// its mutable state in RAM.
+//
+//   constexpr tN2kAlertDefinition AlertDefinitions[] = {
+//       { N2kts_AlertTypeWarning, N2kts_AlertCategoryTechnical, 10, 100, N2kts_AlertTriggerAuto,
+//         N2kAlertSupportAcknowledge, N2kts_AlertThresholddMethodGreater, 0, 60,
+//         1, 1, N2kts_AlertLanguageEnglishUS, "Temperature", "Engine room" },
+//   };
+//   N2kAlertCheckDefinitions(AlertDefinitions);
+//   tN2kAlert TemperatureAlert(AlertDefinitions[0]);
+
+// Compact copy of the mutable state of an alert, used to restore the state
+// after a reset. See N2kAlertPersistence.h
+struct tN2kAlertSnapshot {
+	uint16_t AlertId;
+	uint8_t Occurence;
+	uint8_t State;		// AlertState in bits 0-3, ThresholdStatus in bits 4-7
+	uint8_t Flags;		// N2kAlertSnapshotFlag...
+};
+
+#define N2kAlertSnapshotFlagAcknowledged 0x01
+#define N2kAlertSnapshotFlagSilenced 0x02
+#define N2kAlertSnapshotFlagEscalated 0x04
+
+// Consistent copy of the mutable status of an alert, see GetAlertStatus()
+struct tN2kAlertStatus {
+	tN2kAlertState AlertState;
+	tN2kAlertThresholdStatus ThresholdStatus;
+	tN2kAlertYesNo TemporarySilenceStatus;
+	tN2kAlertYesNo AcknowledgeStatus;
+	tN2kAlertYesNo EscalationStatus;
+	uint8_t EscalationLevel;	// 0 when not escalated, see SetEscalation()
+	uint8_t Occurence;
+};
+
+// Transition handlers are called once for every change of the alert state,
+// threshold status, silence, acknowledge or escalation status and level, with the
+// status before and after the change. They are called by the task that
+// updates the alert, after the new status is stored. A handler may change the
+// alert again; that change is reported to all handlers after the current one.
+class tN2kAlert;
+class tN2kAlertResponseFilter;
+typedef void (*tN2kAlertTransitionHandler)(tN2kAlert &Alert, const tN2kAlertStatus &OldStatus, const tN2kAlertStatus &NewStatus, void* Context);
+
+// Number of transition handler slots per alert
+#ifndef N2kAlertMaxTransitionHandlers
+#define N2kAlertMaxTransitionHandlers 4
+#endif
+
+#define N2kAlertSupportTemporarySilence 0x01
+#define N2kAlertSupportAcknowledge 0x02
+#define N2kAlertSupportEscalation 0x04
+
+struct tN2kAlertDefinition {
+	tN2kAlertType AlertType;
+	tN2kAlertCategory AlertCategory;
+	uint16_t AlertId;
+	uint8_t AlertPriority;
+	tN2kAlertTriggerCondition TriggerCondition;
+	uint8_t Support;
+	t2kNAlertThresholdMethod ThresholdMethod;
+	uint8_t ThresholdFormat;
+	uint64_t ThresholdLevel;
+	uint8_t AlertSystem;
+	uint8_t AlertSubSystem;
+	tN2kAlertLanguage AlertLanguage;
+	const char* AlertDescription;
+	const char* AlertLocation;
+	char* TextBuffer;		// Copies of the texts, allocated by the first SetAlertSystem()
+};
+
+constexpr size_t N2kAlertStrLen(const char* Str) {
+	return (*Str == '\0') ? 0 : 1 + N2kAlertStrLen(Str + 1);
+}
+
+// Escalation is only meaningful for alerts that can be acknowledged
+constexpr bool N2kAlertDefinitionValid(const tN2kAlertDefinition &Definition) {
+	return ((Definition.AlertType == N2kts_AlertTypeEmergencyAlarm) || (Definition.AlertType == N2kts_AlertTypeAlarm) ||
+			(Definition.AlertType == N2kts_AlertTypeWarning) || (Definition.AlertType == N2kts_AlertTypeCaution)) &&
+		(Definition.AlertCategory <= N2kts_AlertCategoryTechnical) &&
+		(Definition.TriggerCondition <= N2kts_AlertTriggerDisabled) &&
+		(Definition.ThresholdMethod <= N2kts_AlertThresholddMethodGreater) &&
+		(Definition.AlertLanguage <= N2kts_AlertLanguageSwedish) &&
+		((Definition.Support & ~(N2kAlertSupportTemporarySilence | N2kAlertSupportAcknowledge | N2kAlertSupportEscalation)) == 0) &&
+		(((Definition.Support & N2kAlertSupportEscalation) == 0) || ((Definition.Support & N2kAlertSupportAcknowledge) != 0)) &&
+		(Definition.AlertDescription != 0) && (N2kAlertStrLen(Definition.AlertDescription) <= N2kAlertTextLen) &&
+		(Definition.AlertLocation != 0) && (N2kAlertStrLen(Definition.AlertLocation) <= N2kAlertTextLen);
+}
+
+// The checks below split their ranges in halves, so the constexpr recursion
+// depth grows with log2 of the table size and large tables still compile.
+constexpr bool N2kAlertDefinitionsValid(const tN2kAlertDefinition* Definitions, size_t First, size_t Last) {
+	return (Last - First == 1) ? N2kAlertDefinitionValid(Definitions[First]) :
+		N2kAlertDefinitionsValid(Definitions, First, First + (Last - First) / 2) &&
+		N2kAlertDefinitionsValid(Definitions, First + (Last - First) / 2, Last);
+}
+
+constexpr bool N2kAlertIdNotIn(const tN2kAlertDefinition* Definitions, uint16_t AlertId, size_t First, size_t Last) {
+	return (First >= Last) ? true :
+		(Last - First == 1) ? (Definitions[First].AlertId != AlertId) :
+		N2kAlertIdNotIn(Definitions, AlertId, First, First + (Last - First) / 2) &&
+		N2kAlertIdNotIn(Definitions, AlertId, First + (Last - First) / 2, Last);
+}
+
+constexpr bool N2kAlertIdsUnique(const tN2kAlertDefinition* Definitions, size_t Count, size_t First, size_t Last) {
+	return (Last - First == 1) ? N2kAlertIdNotIn(Definitions, Definitions[First].AlertId, First + 1, Count) :
+		N2kAlertIdsUnique(Definitions, Count, First, First + (Last - First) / 2) &&
+		N2kAlertIdsUnique(Definitions, Count, First + (Last - First) / 2, Last);
+}
+
+#define N2kAlertCheckDefinitions(Definitions) \
+	static_assert(N2kAlertDefinitionsValid(Definitions, 0, sizeof(Definitions) / sizeof(Definitions[0])), "Invalid alert definition in " #Definitions); \
+	static_assert(N2kAlertIdsUnique(Definitions, sizeof(Definitions) / sizeof(Definitions[0]), 0, sizeof(Definitions) / sizeof(Definitions[0])), "Duplicate AlertId in " #Definitions)
+
 class tN2kAlert {
 public:
 	tN2kAlert(tN2kAlertType _AlertType, tN2kAlertCategory _AlertCategory, uint16_t _AlertId, tN2kAlertTriggerCondition _TriggerCondition = N2kts_AlertTriggerAuto, uint8_t _AlertPriority = 100,
 		tN2kAlertYesNo _TemporarySilenceSupport = N2kts_AlertNo, tN2kAlertYesNo _AcknowledgeSupport = N2kts_AlertNo, tN2kAlertYesNo _EscalationSupport = N2kts_AlertNo);
-	void SetAlertSystem(uint8_t _Alertsystem, uint8_t _AlertSubsystem, uint64_t _AcknowledgeNetworkId, tN2kAlertLanguage _AlertLanguage, char* _AlertDescription, char* _AlertLocation);
+	tN2kAlert(const tN2kAlertDefinition &Definition);
+
+	tN2kAlert(const tN2kAlert&) = delete;
+	tN2kAlert &operator=(const tN2kAlert&) = delete;
+	~tN2kAlert();
+
+	// The description and location texts are copied
+	void SetAlertSystem(uint8_t _Alertsystem, uint8_t _AlertSubsystem, uint64_t _AcknowledgeNetworkId, tN2kAlertLanguage _AlertLanguage, const char* _AlertDescription, const char* _AlertLocation);
+	// As SetAlertSystem(), but the texts are only referenced and must stay valid
+	// as long as the alert, e.g. literals or the texts of a tN2kAlertDefinition
+	void SetAlertSystemStatic(uint8_t _Alertsystem, uint8_t _AlertSubsystem, uint64_t _AcknowledgeNetworkId, tN2kAlertLanguage _AlertLanguage, const char* _AlertDescription, const char* _AlertLocation);
+	void SetAcknowledgeNetworkId(uint64_t _AcknowledgeNetworkId);
 	void SetAlertDataSource(uint8_t _DataSourceInstance, uint8_t _DatesourceIndexSource, uint64_t _DataSourceNetworkId);
 	void SetAlertThreshold(t2kNAlertThresholdMethod _Method, uint8_t _Format, uint64_t _Level);
 
 	uint16_t GetAlertID();
+	const tN2kAlertUID &GetAlertUID() const { return UID; }
 	tN2kAlertType GetAlertType();
 	tN2kAlertCategory GetAlertCategory();
+	uint8_t GetAlertPriority();
+	t2kNAlertThresholdMethod GetAlertThresholdMethod();
+	uint64_t GetAlertThresholdLevel();
 	tN2kAlertThresholdStatus GetAlertThresholdStatus();
 	tN2kAlertState GetAlertState();
 
@@ -36,7 +170,19 @@ public:
 	tN2kAlertYesNo GetAcknowledgeStatus();
 	tN2kAlertYesNo GetEscalationStatus();
 
+	// The status getters may be called from any task or core. GetAlertStatus()
+	// returns all status fields from one atomic read, so the combination is
+	// always one the alert has actually been in.
+	void GetAlertStatus(tN2kAlertStatus &AlertStatus) const;
+
+	bool AttachTransitionHandler(tN2kAlertTransitionHandler Handler, void* Context = 0);
+	void DetachTransitionHandler(tN2kAlertTransitionHandler Handler, void* Context = 0);
+
 	tN2kAlertThresholdStatus TestAlertThreshold(uint64_t v);
+	tN2kAlertThresholdStatus TestAlertCondition(bool Active);
+	uint64_t GetLastValue() const { return LastValue; }
+
+	void GetAlertNotification(tN2kAlertNotification &AlertNotification);
 
 	void SetN2kAlertText(tN2kMsg &N2kMsg);
 	void SetN2kAlert(tN2kMsg &N2kMsg);
@@ -44,22 +190,53 @@ public:
 	void SetTemporarySilenceTime(uint16_t seconds);
 
 	bool ParseAlertResponse(const tN2kMsg &N2kMsg);
+	// Repeated responses are then ignored, see N2kAlertResponseFilter.h. The
+	// filter can be shared by all alerts.
+	void SetResponseFilter(tN2kAlertResponseFilter* _ResponseFilter) { ResponseFilter = _ResponseFilter; }
 
 	bool isAlert();
 	bool isAcknowledged();
 	bool isSilent();
 
+	// Changes the alert type and with it the UID, and sets the escalation
+	// status when Level > 0. Level 0 with the original type ends the
+	// escalation. A 126984 still addressed to the old type no longer matches
+	// in ParseAlertResponse(). The escalation is not part of the snapshot;
+	// RestoreSnapshot() returns to the original type. See N2kAlertEscalation.h
+	void SetEscalation(uint8_t Level, tN2kAlertType _AlertType);
+	uint8_t GetEscalationLevel();
+
+	// Displays still list the alert under a type it had before a type change.
+	// Send the message of SetN2kAlertRetired() for each retired type, before
+	// the new notification, and then call ClearRetired().
+	// tN2kAlertTransmitter does this.
+	bool SetN2kAlertRetired(tN2kMsg &N2kMsg, tN2kAlertType &RetiredType);
+	void ClearRetired(tN2kAlertType RetiredType);
+
+	void SetInhibited(bool Inhibited);
+	bool isInhibited();
+
+	void GetSnapshot(tN2kAlertSnapshot &Snapshot);
+	bool RestoreSnapshot(const tN2kAlertSnapshot &Snapshot);
+
 private:
+	tN2kAlertUID UID;
 	uint16_t AlertId;
 	uint8_t AlertPriority;
 	tN2kAlertType AlertType;
+	tN2kAlertType BaseAlertType;	// Type before any escalation
 	tN2kAlertCategory AlertCategory;
-	tN2kAlertState AlertState;
-	uint8_t Occurence;
+
+	// AlertState, ThresholdStatus, Occurence and the silence, acknowledge,
+	// escalation and inhibit status packed in one word. It is only written by
+	// the task that owns the alert and is stored with one atomic write per
+	// update.
+	volatile uint32_t Status;
 
 	tN2kAlertLanguage AlertLanguage;
-	char AlertDescription[String_Len + 1];
-	char AlertLocation[String_Len + 1];
+	const char* AlertDescription;
+	const char* AlertLocation;
+	char* TextBuffer;		// Copies of the texts, allocated by the first SetAlertSystem()
 
 	uint8_t AlertSystem;
 	uint8_t AlertSubSystem;
@@ -73,22 +250,33 @@ private:
 	tN2kAlertYesNo AcknowledgeSupport;
 	tN2kAlertYesNo EscalationSupport;
 
-	tN2kAlertYesNo TemporarySilenceStatus;
-	tN2kAlertYesNo AcknowledgeStatus;
-	tN2kAlertYesNo EscalationStatus;
-
 	tN2kAlertTriggerCondition TriggerCondition;
-	tN2kAlertThresholdStatus ThresholdStatus;
 
 	t2kNAlertThresholdMethod ThresholdMethod;
 	uint8_t ThresholdFormat;
 	uint64_t ThresholdLevel;
+	uint64_t LastValue;
 
 	tN2kScheduler TemporarySilenceTimer;
 	uint32_t TemporarySilenceDelay;
+	tN2kAlertResponseFilter* ResponseFilter;
+	uint16_t RetiredTypes;	// Bit per alert type that still needs a last notification
+	bool Dispatching;		// StoreStatus() is calling the transition handlers
+
+	struct tTransitionSlot {
+		tN2kAlertTransitionHandler Handler;
+		void* Context;
+	};
+	tTransitionSlot TransitionSlots[N2kAlertMaxTransitionHandlers];
 
-	void SetAlertExceeded();
-	void ResetAlert();
+	void UpdateAlertUID();
+	void ChangeAlertType(tN2kAlertType _AlertType);
+	void GetAlertKey(tN2kAlertKey &Key);
+	uint32_t LoadStatus() const;
+	void StoreStatus(uint32_t _Status);
+	uint32_t SetAlertExceeded(uint32_t _Status);
+	uint32_t ResetAlert(uint32_t _Status);
+	tN2kAlertThresholdStatus UpdateAlert(bool Exceeded);
 };
 
 #endif